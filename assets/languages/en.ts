@@ -76,6 +76,10 @@
         <source>commandLineDescription</source>
         <translation>send an order to the application towards a command line</translation>
     </message>
+    <message>
+        <source>commandLineOptionTraceStartup</source>
+        <translation>write a trace of the startup phases, readable with chrome://tracing</translation>
+    </message>
 </context>
 <context>
     <name>AssistantAbstractView</name>
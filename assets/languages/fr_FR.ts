@@ -76,6 +76,10 @@
         <source>commandLineDescription</source>
         <translation>envoie un ordre à l&apos;application Linphone, voir --cli-help pour plus de détails</translation>
     </message>
+    <message>
+        <source>commandLineOptionTraceStartup</source>
+        <translation>écrit une trace des phases de démarrage, lisible avec chrome://tracing</translation>
+    </message>
 </context>
 <context>
     <name>AssistantAbstractView</name>
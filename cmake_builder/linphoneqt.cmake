@@ -27,6 +27,7 @@ lcb_groupable(YES)
 lcb_package_source(YES)
 
 lcb_cmake_options("-DENABLE_UPDATE_CHECK=${ENABLE_UPDATE_CHECK}")
+lcb_cmake_options("-DENABLE_PREBUILT_IMAGES=${ENABLE_PREBUILT_IMAGES}")
 if(UNIX AND NOT APPLE)
 	lcb_cmake_options("-DENABLE_DBUS=${ENABLE_DBUS}")
 endif()
@@ -22,3 +22,4 @@
 
 #cmakedefine MSPLUGINS_DIR "${MSPLUGINS_DIR}"
 #cmakedefine ENABLE_UPDATE_CHECK 1
+#cmakedefine ENABLE_PREBUILT_IMAGES 1
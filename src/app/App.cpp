@@ -33,6 +33,7 @@
 
 #include "../components/Components.hpp"
 #include "../utils/LinphoneUtils.hpp"
+#include "../utils/StartupProfiler.hpp"
 #include "../utils/Utils.hpp"
 
 #include "cli/Cli.hpp"
@@ -79,14 +80,22 @@ static inline shared_ptr<linphone::Config> getConfigIfExists (const QCommandLine
 // -----------------------------------------------------------------------------
 
 App::App (int &argc, char *argv[]) : SingleApplication(argc, argv, true, Mode::User | Mode::ExcludeAppPath | Mode::ExcludeAppVersion) {
+  StartupProfiler::Span span("App");
+
   setWindowIcon(QIcon(WINDOW_ICON_PATH));
 
   createParser();
   mParser->process(*this);
 
+  if (mParser->isSet("trace-startup"))
+    StartupProfiler::setOutputPath(mParser->value("trace-startup"));
+
   // Initialize logger.
   shared_ptr<linphone::Config> config = ::getConfigIfExists(*mParser);
-  Logger::init(config);
+  {
+    StartupProfiler::Span span("Logger::init");
+    Logger::init(config);
+  }
   if (mParser->isSet("verbose"))
     Logger::getInstance()->setVerbose(true);
 
@@ -148,6 +157,8 @@ static void activeSplashScreen (QQmlApplicationEngine *engine) {
 }
 
 void App::initContentApp () {
+  StartupProfiler::Span span("App::initContentApp");
+
   shared_ptr<linphone::Config> config = ::getConfigIfExists(*mParser);
   bool mustBeIconified = false;
 
@@ -184,7 +195,10 @@ void App::initContentApp () {
   }
 
   // Init core.
-  CoreManager::init(this, mParser->value("config"));
+  {
+    StartupProfiler::Span span("CoreManager::init");
+    CoreManager::init(this, mParser->value("config"));
+  }
 
   // Execute command argument if needed.
   if (!mEngine) {
@@ -202,11 +216,16 @@ void App::initContentApp () {
 
   // Provide `+custom` folders for custom components and `5.9` for old components.
   // TODO: Remove 5.9 support in 6 months. (~ July 2018).
+  // `+prebuilt-images` loads the icons with `ImageProvider`, which uses the images
+  // recolored and rasterized at build time.
   {
     QStringList selectors("custom");
     const QVersionNumber &version = QLibraryInfo::version();
     if (version.majorVersion() == 5 && version.minorVersion() == 9)
       selectors.push_back("5.9");
+    #ifdef ENABLE_PREBUILT_IMAGES
+      selectors.push_back("prebuilt-images");
+    #endif // ifdef ENABLE_PREBUILT_IMAGES
     (new QQmlFileSelector(mEngine, mEngine))->setExtraSelectors(selectors);
   }
   qInfo() << QStringLiteral("Activated selectors:") << QQmlFileSelector::get(mEngine)->selector()->allSelectors();
@@ -219,7 +238,6 @@ void App::initContentApp () {
   // Provide avatars/thumbnails providers.
   mEngine->addImageProvider(AvatarProvider::PROVIDER_ID, new AvatarProvider());
   mEngine->addImageProvider(ImageProvider::PROVIDER_ID, new ImageProvider());
-  mEngine->addImageProvider(ThumbnailProvider::PROVIDER_ID, new ThumbnailProvider());
 
   mColors = new Colors(this);
   mColors->useConfig(config);
@@ -242,13 +260,27 @@ void App::initContentApp () {
 
   // Load main view.
   qInfo() << QStringLiteral("Loading main view...");
-  mEngine->load(QUrl(cQmlViewMainWindow));
+  {
+    StartupProfiler::Span span("MainWindow.qml");
+    mEngine->load(QUrl(cQmlViewMainWindow));
+  }
   if (mEngine->rootObjects().isEmpty())
     qFatal("Unable to open main window.");
 
   QObject::connect(CoreManager::getInstance()->getHandlers().get(),
     &CoreHandlers::coreStarted, [this, mustBeIconified]() {
-      openAppAfterInit(mustBeIconified);
+      // The thumbnails cache is created at core start. The engine is deleted
+      // before the core manager, so the provider never outlives the cache.
+      mEngine->addImageProvider(
+        ThumbnailProvider::PROVIDER_ID,
+        new ThumbnailProvider(CoreManager::getInstance()->getThumbnailsCache())
+      );
+
+      {
+        StartupProfiler::Span span("App::openAppAfterInit");
+        openAppAfterInit(mustBeIconified);
+      }
+      StartupProfiler::finish();
     });
 }
 
@@ -343,7 +375,8 @@ void App::createParser () {
     #ifndef Q_OS_MACOS
       { "iconified", tr("commandLineOptionIconified") },
     #endif // ifndef Q_OS_MACOS
-    { { "V", "verbose" }, tr("commandLineOptionVerbose") }
+    { { "V", "verbose" }, tr("commandLineOptionVerbose") },
+    { "trace-startup", tr("commandLineOptionTraceStartup"), tr("commandLineOptionConfigArg") }
   });
 }
 
@@ -46,6 +46,7 @@
 #define PATH_ROOT_CA "/linphone/rootca.pem"
 #define PATH_FRIENDS_LIST "/friends.db"
 #define PATH_MESSAGE_HISTORY_LIST "/message-history.db"
+#define PATH_TIMELINE_SNAPSHOT "/timeline.json"
 #define PATH_ZRTP_SECRETS "/zidcache"
 
 using namespace std;
@@ -227,6 +228,10 @@ string Paths::getThumbnailsDirPath () {
   return ::getWritableDirPath(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + PATH_THUMBNAILS);
 }
 
+string Paths::getTimelineSnapshotFilePath () {
+  return ::getWritableFilePath(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + PATH_TIMELINE_SNAPSHOT);
+}
+
 string Paths::getUserCertificatesDirPath () {
   return ::getWritableDirPath(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + PATH_USER_CERTIFICATES);
 }
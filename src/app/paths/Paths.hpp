@@ -45,6 +45,7 @@ namespace Paths {
   std::string getPluginsDirPath ();
   std::string getRootCaFilePath ();
   std::string getThumbnailsDirPath ();
+  std::string getTimelineSnapshotFilePath ();
   std::string getUserCertificatesDirPath ();
   std::string getZrtpDataFilePath ();
   std::string getZrtpSecretsFilePath ();
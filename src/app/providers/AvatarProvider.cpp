@@ -27,17 +27,22 @@
 
 // =============================================================================
 
+namespace {
+  // In bytes.
+  constexpr int cCacheMaxSize = 8 * 1024 * 1024;
+}
+
 const QString AvatarProvider::PROVIDER_ID = "avatar";
 
 AvatarProvider::AvatarProvider () : QQuickImageProvider(
     QQmlImageProviderBase::Image,
     QQmlImageProviderBase::ForceAsynchronousImageLoading
-  ) {
+  ), mCache(PROVIDER_ID, cCacheMaxSize) {
   mAvatarsPath = ::Utils::coreStringToAppString(Paths::getAvatarsDirPath());
 }
 
-QImage AvatarProvider::requestImage (const QString &id, QSize *size, const QSize &) {
-  QImage image(mAvatarsPath + id);
+QImage AvatarProvider::requestImage (const QString &id, QSize *size, const QSize &requestedSize) {
+  QImage image = mCache.load(mAvatarsPath + id, requestedSize);
   *size = image.size();
   return image;
 }
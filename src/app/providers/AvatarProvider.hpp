@@ -25,6 +25,8 @@
 
 #include <QQuickImageProvider>
 
+#include "ScaledImageCache.hpp"
+
 // =============================================================================
 
 class AvatarProvider : public QQuickImageProvider {
@@ -36,8 +38,17 @@ public:
 
   static const QString PROVIDER_ID;
 
+  int getCacheHits () const {
+    return mCache.getHits();
+  }
+
+  int getCacheMisses () const {
+    return mCache.getMisses();
+  }
+
 private:
   QString mAvatarsPath;
+  ScaledImageCache mCache;
 };
 
 #endif // AVATAR_PROVIDER_H_
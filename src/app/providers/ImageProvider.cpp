@@ -26,6 +26,7 @@
 #include <QSvgRenderer>
 
 #include "../App.hpp"
+#include "SvgColorizer.hpp"
 
 #include "ImageProvider.hpp"
 
@@ -36,237 +37,122 @@ using namespace std;
 namespace {
   // Max image size in bytes. (100Kb)
   constexpr qint64 cMaxImageSize = 102400;
-}
 
-static void removeAttribute (QXmlStreamAttributes &readerAttributes, const QString &name) {
-  auto it = find_if(readerAttributes.cbegin(), readerAttributes.cend(), [&name](const QXmlStreamAttribute &attribute) {
-        return name == attribute.name() && !attribute.prefix().length();
-      });
-  if (it != readerAttributes.cend())
-    readerAttributes.remove(int(distance(readerAttributes.cbegin(), it)));
-}
+  // Max size of the rasterized images cache in bytes. (8Mb)
+  constexpr int cImagesCacheMaxSize = 8388608;
 
-static QByteArray buildByteArrayAttribute (const QByteArray &name, const QByteArray &value) {
-  QByteArray attribute = name;
-  attribute.append("=\"");
-  attribute.append(value);
-  attribute.append("\" ");
-  return attribute;
+  // Images recolored with the default palette at build time.
+  // Only available with `ENABLE_PREBUILT_IMAGES`. Not used if `ui_colors` overrides
+  // the palette: the images are recolored at runtime.
+  constexpr char cPrebuiltImagesPath[] = ":/prebuilt-images/";
 }
 
-static QByteArray parseFillAndStroke (QXmlStreamAttributes &readerAttributes, const Colors &colors) {
-  static QRegExp regex("^color-([^-]+)-(fill|stroke)$");
-
-  QByteArray attributes;
-
-  for (const auto &classValue : readerAttributes.value("class").toLatin1().split(' ')) {
-    regex.indexIn(classValue.trimmed());
-    if (Q_LIKELY(regex.pos() == -1))
-      continue;
-
-    const QStringList list = regex.capturedTexts();
-
-    const QVariant colorValue = colors.property(list[1].toStdString().c_str());
-    if (Q_UNLIKELY(!colorValue.isValid())) {
-      qWarning() << QStringLiteral("Color name `%1` does not exist.").arg(list[1]);
-      continue;
-    }
+// -----------------------------------------------------------------------------
 
-    ::removeAttribute(readerAttributes, list[2]);
-    attributes.append(::buildByteArrayAttribute(list[2].toLatin1(), colorValue.value<QColor>().name().toLatin1()));
-  }
+const QString ImageProvider::PROVIDER_ID = "internal";
 
-  return attributes;
+ImageProvider::ImageProvider () : QQuickImageProvider(
+    QQmlImageProviderBase::Image,
+    QQmlImageProviderBase::ForceAsynchronousImageLoading
+  ) {
+  mImages.setMaxCost(cImagesCacheMaxSize);
 }
 
-static QByteArray parseStyle (QXmlStreamAttributes &readerAttributes, const Colors &colors) {
-  static QRegExp regex("^color-([^-]+)-style-(fill|stroke)$");
-
-  QByteArray attribute;
-
-  QSet<QString> overrode;
-  for (const auto &classValue : readerAttributes.value("class").toLatin1().split(' ')) {
-    regex.indexIn(classValue.trimmed());
-    if (Q_LIKELY(regex.pos() == -1))
-      continue;
-
-    const QStringList list = regex.capturedTexts();
-
-    overrode.insert(list[2]);
-
-    const QVariant colorValue = colors.property(list[1].toStdString().c_str());
-    if (Q_UNLIKELY(!colorValue.isValid())) {
-      qWarning() << QStringLiteral("Color name `%1` does not exist.").arg(list[1]);
-      continue;
-    }
+// -----------------------------------------------------------------------------
 
-    attribute.append(list[2].toLatin1());
-    attribute.append(":");
-    attribute.append(colorValue.value<QColor>().name().toLatin1());
-    attribute.append(";");
+QByteArray ImageProvider::getContent (const QString &id, int colorsGeneration) {
+  {
+    QMutexLocker locker(&mMutex);
+    auto it = mContents.constFind(id);
+    if (it != mContents.cend() && it->first == colorsGeneration)
+      return it->second;
   }
 
-  const QByteArrayList styleValues = readerAttributes.value("style").toLatin1().split(';');
-  for (const auto &styleValue : styleValues) {
-    const QByteArrayList list = styleValue.split(':');
-    if (Q_UNLIKELY(list.length() > 0 && !overrode.contains(list[0]))) {
-      attribute.append(styleValue);
-      attribute.append(";");
+  // Default palette: use the prebuilt content if it exists.
+  if (colorsGeneration == 0) {
+    QFile file(cPrebuiltImagesPath + id);
+    if (file.open(QIODevice::ReadOnly)) {
+      const QByteArray content = file.readAll();
+
+      QMutexLocker locker(&mMutex);
+      mContents[id] = qMakePair(colorsGeneration, content);
+      return content;
     }
   }
 
-  ::removeAttribute(readerAttributes, "style");
+  const QString path = QStringLiteral(":/assets/images/%1").arg(id);
 
-  if (attribute.length() > 0) {
-    attribute.prepend("style=\"");
-    attribute.append("\" ");
+  QFile file(path);
+  if (Q_UNLIKELY(QFileInfo(file).size() > cMaxImageSize)) {
+    qWarning() << QStringLiteral("Unable to open large file: `%1`.").arg(path);
+    return QByteArray();
   }
 
-  return attribute;
-}
-
-static QByteArray parseAttributes (const QXmlStreamReader &reader, const Colors &colors) {
-  QXmlStreamAttributes readerAttributes = reader.attributes();
-
-  QByteArray attributes = ::parseFillAndStroke(readerAttributes, colors);
-  attributes.append(::parseStyle(readerAttributes, colors));
-
-  for (const auto &attribute : readerAttributes) {
-    const QByteArray prefix = attribute.prefix().toLatin1();
-    if (Q_UNLIKELY(prefix.length() > 0)) {
-      attributes.append(prefix);
-      attributes.append(":");
-    }
-
-    attributes.append(
-      ::buildByteArrayAttribute(attribute.name().toLatin1(), attribute.value().toLatin1())
-    );
+  if (Q_UNLIKELY(!file.open(QIODevice::ReadOnly))) {
+    qWarning() << QStringLiteral("Unable to open file: `%1`.").arg(path);
+    return QByteArray();
   }
 
-  return attributes;
-}
-
-static QByteArray parseDeclarations (const QXmlStreamReader &reader) {
-  QByteArray declarations;
-  for (const auto &declaration : reader.namespaceDeclarations()) {
-    const QByteArray prefix = declaration.prefix().toLatin1();
-    if (Q_UNLIKELY(prefix.length() > 0)) {
-      declarations.append("xmlns:");
-      declarations.append(prefix);
-    } else
-      declarations.append("xmlns");
-
-    declarations.append("=\"");
-    declarations.append(declaration.namespaceUri().toLatin1());
-    declarations.append("\" ");
+  const QByteArray content = SvgColorizer::colorize(file, *App::getInstance()->getColors());
+  if (Q_UNLIKELY(!content.length())) {
+    qWarning() << QStringLiteral("Unable to parse file: `%1`.").arg(path);
+    return QByteArray();
   }
 
-  return declarations;
-}
-
-static QByteArray parseStartDocument (const QXmlStreamReader &reader) {
-  QByteArray startDocument = "<?xml version=\"";
-  startDocument.append(reader.documentVersion().toLatin1());
-  startDocument.append("\" encoding=\"");
-  startDocument.append(reader.documentEncoding().toLatin1());
-  startDocument.append("\"?>");
-  return startDocument;
+  QMutexLocker locker(&mMutex);
+  mContents[id] = qMakePair(colorsGeneration, content);
+  return content;
 }
 
-static QByteArray parseStartElement (const QXmlStreamReader &reader, const Colors &colors) {
-  QByteArray startElement = "<";
-  startElement.append(reader.name().toLatin1());
-  startElement.append(" ");
-  startElement.append(::parseAttributes(reader, colors));
-  startElement.append(" ");
-  startElement.append(::parseDeclarations(reader));
-  startElement.append(">");
-  return startElement;
-}
-
-static QByteArray parseEndElement (const QXmlStreamReader &reader) {
-  QByteArray endElement = "</";
-  endElement.append(reader.name().toLatin1());
-  endElement.append(">");
-  return endElement;
-}
+QImage ImageProvider::requestImage (const QString &id, QSize *size, const QSize &requestedSize) {
+  const QString path = QStringLiteral(":/assets/images/%1").arg(id);
+  const int colorsGeneration = App::getInstance()->getColors()->getGeneration();
+  const QString key = QStringLiteral("%1:%2:%3x%4")
+    .arg(colorsGeneration).arg(path).arg(requestedSize.width()).arg(requestedSize.height());
 
-// -----------------------------------------------------------------------------
+  {
+    QMutexLocker locker(&mMutex);
 
-static QByteArray computeContent (QFile &file) {
-  const Colors *colors = App::getInstance()->getColors();
-
-  QByteArray content;
-  QXmlStreamReader reader(&file);
-  while (!reader.atEnd())
-    switch (reader.readNext()) {
-      case QXmlStreamReader::Comment:
-      case QXmlStreamReader::DTD:
-      case QXmlStreamReader::EndDocument:
-      case QXmlStreamReader::Invalid:
-      case QXmlStreamReader::NoToken:
-      case QXmlStreamReader::ProcessingInstruction:
-        break;
-
-      case QXmlStreamReader::StartDocument:
-        content.append(::parseStartDocument(reader));
-        break;
-
-      case QXmlStreamReader::StartElement:
-        content.append(::parseStartElement(reader, *colors));
-        break;
-
-      case QXmlStreamReader::EndElement:
-        content.append(::parseEndElement(reader));
-        break;
-
-      case QXmlStreamReader::Characters:
-        content.append(reader.text().toLatin1());
-        break;
-
-      case QXmlStreamReader::EntityReference:
-        content.append(reader.name().toLatin1());
-        break;
+    // Colors changed, the old images are useless.
+    if (colorsGeneration != mImagesColorsGeneration) {
+      mImages.clear();
+      mImagesColorsGeneration = colorsGeneration;
     }
 
-  return reader.hasError() ? QByteArray() : content;
-}
-
-// -----------------------------------------------------------------------------
-
-const QString ImageProvider::PROVIDER_ID = "internal";
-
-ImageProvider::ImageProvider () : QQuickImageProvider(
-    QQmlImageProviderBase::Image,
-    QQmlImageProviderBase::ForceAsynchronousImageLoading
-  ) {}
+    const QImage *image = mImages.object(key);
+    if (image) {
+      *size = image->size();
+      return *image;
+    }
+  }
 
-// -----------------------------------------------------------------------------
+  // Default palette: use the prebuilt image if it exists at this size.
+  // Without requested size, the image is rasterized at its natural size.
+  if (colorsGeneration == 0) {
+    const bool isNatural = requestedSize.width() <= 0 && requestedSize.height() <= 0;
+    QImage image(isNatural
+      ? QStringLiteral("%1natural/%2.png").arg(cPrebuiltImagesPath).arg(QFileInfo(id).completeBaseName())
+      : QStringLiteral("%1%2x%3/%4.png")
+        .arg(cPrebuiltImagesPath).arg(requestedSize.width()).arg(requestedSize.height())
+        .arg(QFileInfo(id).completeBaseName()));
+    if (!image.isNull()) {
+      *size = image.size();
+
+      QMutexLocker locker(&mMutex);
+      mImages.insert(key, new QImage(image), image.byteCount());
+      return image;
+    }
+  }
 
-QImage ImageProvider::requestImage (const QString &id, QSize *size, const QSize &requestedSize) {
-  const QString path = QStringLiteral(":/assets/images/%1").arg(id);
   qInfo() << QStringLiteral("Image `%1` requested.").arg(path);
 
   QElapsedTimer timer;
   timer.start();
 
   // 1. Read and update XML content.
-  QFile file(path);
-  if (Q_UNLIKELY(QFileInfo(file).size() > cMaxImageSize)) {
-    qWarning() << QStringLiteral("Unable to open large file: `%1`.").arg(path);
+  const QByteArray content = getContent(id, colorsGeneration);
+  if (Q_UNLIKELY(!content.length()))
     return QImage();
-  }
-
-  if (Q_UNLIKELY(!file.open(QIODevice::ReadOnly))) {
-    qWarning() << QStringLiteral("Unable to open file: `%1`.").arg(path);
-    return QImage();
-  }
-
-  const QByteArray content = ::computeContent(file);
-  if (Q_UNLIKELY(!content.length())) {
-    qWarning() << QStringLiteral("Unable to parse file: `%1`.").arg(path);
-    return QImage();
-  }
 
   // 2. Build svg renderer.
   QSvgRenderer renderer(content);
@@ -294,10 +180,15 @@ QImage ImageProvider::requestImage (const QString &id, QSize *size, const QSize
   *size = image.size();
 
   // 4. Paint!
-  QPainter painter(&image);
-  renderer.render(&painter);
+  {
+    QPainter painter(&image);
+    renderer.render(&painter);
+  }
 
   qInfo() << QStringLiteral("Image `%1` loaded in %2 milliseconds.").arg(path).arg(timer.elapsed());
 
+  QMutexLocker locker(&mMutex);
+  mImages.insert(key, new QImage(image), image.byteCount());
+
   return image;
 }
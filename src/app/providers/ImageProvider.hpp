@@ -23,6 +23,9 @@
 #ifndef IMAGE_PROVIDER_H_
 #define IMAGE_PROVIDER_H_
 
+#include <QCache>
+#include <QHash>
+#include <QMutex>
 #include <QQuickImageProvider>
 
 // =============================================================================
@@ -35,6 +38,18 @@ public:
   QImage requestImage (const QString &id, QSize *size, const QSize &requestedSize) override;
 
   static const QString PROVIDER_ID;
+
+private:
+  QByteArray getContent (const QString &id, int colorsGeneration);
+
+  // Recolored svg files. Id => (colors generation, content).
+  QHash<QString, QPair<int, QByteArray> > mContents;
+
+  // Rasterized images. Keyed by colors generation, path and size.
+  QCache<QString, QImage> mImages;
+  int mImagesColorsGeneration = 0;
+
+  QMutex mMutex;
 };
 
 #endif // IMAGE_PROVIDER_H_
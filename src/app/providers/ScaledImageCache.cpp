@@ -0,0 +1,84 @@
+/*
+ * ScaledImageCache.cpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#include <QImageReader>
+
+#include "ScaledImageCache.hpp"
+
+// =============================================================================
+
+ScaledImageCache::ScaledImageCache (const QString &name, int maxSize) : mName(name) {
+  // The cost of an image is its size in bytes.
+  mCache.setMaxCost(maxSize);
+}
+
+ScaledImageCache::~ScaledImageCache () {
+  qInfo() << QStringLiteral("Images cache `%1`: %2 hits, %3 misses.")
+    .arg(mName).arg(getHits()).arg(getMisses());
+}
+
+// -----------------------------------------------------------------------------
+
+QImage ScaledImageCache::load (const QString &path, const QSize &requestedSize) {
+  const QString key = QStringLiteral("%1:%2x%3")
+    .arg(path).arg(requestedSize.width()).arg(requestedSize.height());
+
+  {
+    QMutexLocker locker(&mMutex);
+    const QImage *image = mCache.object(key);
+    if (image) {
+      mHits.ref();
+      return *image;
+    }
+  }
+
+  // Decode without lock. Two threads can decode the same image, but it's rare.
+  mMisses.ref();
+  QImage image = decode(path, requestedSize);
+  if (image.isNull())
+    return image;
+
+  QMutexLocker locker(&mMutex);
+  mCache.insert(key, new QImage(image), image.byteCount());
+  return image;
+}
+
+// -----------------------------------------------------------------------------
+
+QImage ScaledImageCache::decode (const QString &path, const QSize &requestedSize) {
+  QImageReader reader(path);
+  reader.setAutoTransform(true);
+
+  // Scale down only, the aspect ratio is kept.
+  // A null dimension in the requested size is computed from the other one.
+  const QSize size = reader.size();
+  if (size.isValid() && (requestedSize.width() > 0 || requestedSize.height() > 0)) {
+    QSize scaledSize = size.scaled(
+      requestedSize.width() > 0 ? requestedSize.width() : size.width(),
+      requestedSize.height() > 0 ? requestedSize.height() : size.height(),
+      Qt::KeepAspectRatio
+    );
+    if (scaledSize.width() < size.width())
+      reader.setScaledSize(scaledSize);
+  }
+
+  return reader.read();
+}
@@ -0,0 +1,62 @@
+/*
+ * ScaledImageCache.hpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef SCALED_IMAGE_CACHE_H_
+#define SCALED_IMAGE_CACHE_H_
+
+#include <QAtomicInt>
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+
+// =============================================================================
+// LRU memory cache of images decoded at the requested size.
+// Used by the image providers. Thread-safe.
+// =============================================================================
+
+class ScaledImageCache {
+public:
+  ScaledImageCache (const QString &name, int maxSize);
+  ~ScaledImageCache ();
+
+  QImage load (const QString &path, const QSize &requestedSize);
+
+  int getHits () const {
+    return mHits.load();
+  }
+
+  int getMisses () const {
+    return mMisses.load();
+  }
+
+private:
+  static QImage decode (const QString &path, const QSize &requestedSize);
+
+  QString mName;
+
+  QMutex mMutex;
+  QCache<QString, QImage> mCache;
+
+  QAtomicInt mHits;
+  QAtomicInt mMisses;
+};
+
+#endif // SCALED_IMAGE_CACHE_H_
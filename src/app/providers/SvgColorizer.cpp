@@ -0,0 +1,226 @@
+/*
+ * SvgColorizer.cpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#include <algorithm>
+
+#include <QColor>
+#include <QRegExp>
+#include <QSet>
+#include <QVariant>
+#include <QXmlStreamReader>
+
+#include "SvgColorizer.hpp"
+
+using namespace std;
+
+// =============================================================================
+
+static void removeAttribute (QXmlStreamAttributes &readerAttributes, const QString &name) {
+  auto it = find_if(readerAttributes.cbegin(), readerAttributes.cend(), [&name](const QXmlStreamAttribute &attribute) {
+        return name == attribute.name() && !attribute.prefix().length();
+      });
+  if (it != readerAttributes.cend())
+    readerAttributes.remove(int(distance(readerAttributes.cbegin(), it)));
+}
+
+static QByteArray buildByteArrayAttribute (const QByteArray &name, const QByteArray &value) {
+  QByteArray attribute = name;
+  attribute.append("=\"");
+  attribute.append(value);
+  attribute.append("\" ");
+  return attribute;
+}
+
+static QByteArray parseFillAndStroke (QXmlStreamAttributes &readerAttributes, const QObject &colors) {
+  static QRegExp regex("^color-([^-]+)-(fill|stroke)$");
+
+  QByteArray attributes;
+
+  for (const auto &classValue : readerAttributes.value("class").toLatin1().split(' ')) {
+    regex.indexIn(classValue.trimmed());
+    if (Q_LIKELY(regex.pos() == -1))
+      continue;
+
+    const QStringList list = regex.capturedTexts();
+
+    const QVariant colorValue = colors.property(list[1].toStdString().c_str());
+    if (Q_UNLIKELY(!colorValue.isValid())) {
+      qWarning() << QStringLiteral("Color name `%1` does not exist.").arg(list[1]);
+      continue;
+    }
+
+    ::removeAttribute(readerAttributes, list[2]);
+    attributes.append(::buildByteArrayAttribute(list[2].toLatin1(), colorValue.value<QColor>().name().toLatin1()));
+  }
+
+  return attributes;
+}
+
+static QByteArray parseStyle (QXmlStreamAttributes &readerAttributes, const QObject &colors) {
+  static QRegExp regex("^color-([^-]+)-style-(fill|stroke)$");
+
+  QByteArray attribute;
+
+  QSet<QString> overrode;
+  for (const auto &classValue : readerAttributes.value("class").toLatin1().split(' ')) {
+    regex.indexIn(classValue.trimmed());
+    if (Q_LIKELY(regex.pos() == -1))
+      continue;
+
+    const QStringList list = regex.capturedTexts();
+
+    overrode.insert(list[2]);
+
+    const QVariant colorValue = colors.property(list[1].toStdString().c_str());
+    if (Q_UNLIKELY(!colorValue.isValid())) {
+      qWarning() << QStringLiteral("Color name `%1` does not exist.").arg(list[1]);
+      continue;
+    }
+
+    attribute.append(list[2].toLatin1());
+    attribute.append(":");
+    attribute.append(colorValue.value<QColor>().name().toLatin1());
+    attribute.append(";");
+  }
+
+  const QByteArrayList styleValues = readerAttributes.value("style").toLatin1().split(';');
+  for (const auto &styleValue : styleValues) {
+    const QByteArrayList list = styleValue.split(':');
+    if (Q_UNLIKELY(list.length() > 0 && !overrode.contains(list[0]))) {
+      attribute.append(styleValue);
+      attribute.append(";");
+    }
+  }
+
+  ::removeAttribute(readerAttributes, "style");
+
+  if (attribute.length() > 0) {
+    attribute.prepend("style=\"");
+    attribute.append("\" ");
+  }
+
+  return attribute;
+}
+
+static QByteArray parseAttributes (const QXmlStreamReader &reader, const QObject &colors) {
+  QXmlStreamAttributes readerAttributes = reader.attributes();
+
+  QByteArray attributes = ::parseFillAndStroke(readerAttributes, colors);
+  attributes.append(::parseStyle(readerAttributes, colors));
+
+  for (const auto &attribute : readerAttributes) {
+    const QByteArray prefix = attribute.prefix().toLatin1();
+    if (Q_UNLIKELY(prefix.length() > 0)) {
+      attributes.append(prefix);
+      attributes.append(":");
+    }
+
+    attributes.append(
+      ::buildByteArrayAttribute(attribute.name().toLatin1(), attribute.value().toLatin1())
+    );
+  }
+
+  return attributes;
+}
+
+static QByteArray parseDeclarations (const QXmlStreamReader &reader) {
+  QByteArray declarations;
+  for (const auto &declaration : reader.namespaceDeclarations()) {
+    const QByteArray prefix = declaration.prefix().toLatin1();
+    if (Q_UNLIKELY(prefix.length() > 0)) {
+      declarations.append("xmlns:");
+      declarations.append(prefix);
+    } else
+      declarations.append("xmlns");
+
+    declarations.append("=\"");
+    declarations.append(declaration.namespaceUri().toLatin1());
+    declarations.append("\" ");
+  }
+
+  return declarations;
+}
+
+static QByteArray parseStartDocument (const QXmlStreamReader &reader) {
+  QByteArray startDocument = "<?xml version=\"";
+  startDocument.append(reader.documentVersion().toLatin1());
+  startDocument.append("\" encoding=\"");
+  startDocument.append(reader.documentEncoding().toLatin1());
+  startDocument.append("\"?>");
+  return startDocument;
+}
+
+static QByteArray parseStartElement (const QXmlStreamReader &reader, const QObject &colors) {
+  QByteArray startElement = "<";
+  startElement.append(reader.name().toLatin1());
+  startElement.append(" ");
+  startElement.append(::parseAttributes(reader, colors));
+  startElement.append(" ");
+  startElement.append(::parseDeclarations(reader));
+  startElement.append(">");
+  return startElement;
+}
+
+static QByteArray parseEndElement (const QXmlStreamReader &reader) {
+  QByteArray endElement = "</";
+  endElement.append(reader.name().toLatin1());
+  endElement.append(">");
+  return endElement;
+}
+
+// -----------------------------------------------------------------------------
+
+QByteArray SvgColorizer::colorize (QIODevice &device, const QObject &colors) {
+  QByteArray content;
+  QXmlStreamReader reader(&device);
+  while (!reader.atEnd())
+    switch (reader.readNext()) {
+      case QXmlStreamReader::Comment:
+      case QXmlStreamReader::DTD:
+      case QXmlStreamReader::EndDocument:
+      case QXmlStreamReader::Invalid:
+      case QXmlStreamReader::NoToken:
+      case QXmlStreamReader::ProcessingInstruction:
+        break;
+
+      case QXmlStreamReader::StartDocument:
+        content.append(::parseStartDocument(reader));
+        break;
+
+      case QXmlStreamReader::StartElement:
+        content.append(::parseStartElement(reader, colors));
+        break;
+
+      case QXmlStreamReader::EndElement:
+        content.append(::parseEndElement(reader));
+        break;
+
+      case QXmlStreamReader::Characters:
+        content.append(reader.text().toLatin1());
+        break;
+
+      case QXmlStreamReader::EntityReference:
+        content.append(reader.name().toLatin1());
+        break;
+    }
+
+  return reader.hasError() ? QByteArray() : content;
+}
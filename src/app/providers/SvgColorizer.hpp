@@ -0,0 +1,41 @@
+/*
+ * SvgColorizer.hpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef SVG_COLORIZER_H_
+#define SVG_COLORIZER_H_
+
+#include <QByteArray>
+
+// =============================================================================
+// Apply a palette on a svg file. The elements use the classes:
+// `color-<name>-fill`, `color-<name>-stroke`, `color-<name>-style-fill` and
+// `color-<name>-style-stroke`, where `<name>` is a property of `colors`.
+// =============================================================================
+
+class QIODevice;
+class QObject;
+
+namespace SvgColorizer {
+  // Returns an empty array on parsing error.
+  QByteArray colorize (QIODevice &device, const QObject &colors);
+}
+
+#endif // SVG_COLORIZER_H_
@@ -20,6 +20,7 @@
  *      Author: Ronan Abhamon
  */
 
+#include "../../components/chat/ThumbnailsCache.hpp"
 #include "../../utils/Utils.hpp"
 #include "../paths/Paths.hpp"
 
@@ -27,17 +28,25 @@
 
 // =============================================================================
 
+namespace {
+  // In bytes.
+  constexpr int cCacheMaxSize = 16 * 1024 * 1024;
+}
+
 const QString ThumbnailProvider::PROVIDER_ID = "thumbnail";
 
-ThumbnailProvider::ThumbnailProvider () : QQuickImageProvider(
+ThumbnailProvider::ThumbnailProvider (ThumbnailsCache *thumbnailsCache) : QQuickImageProvider(
     QQmlImageProviderBase::Image,
     QQmlImageProviderBase::ForceAsynchronousImageLoading
-  ) {
+  ), mThumbnailsCache(thumbnailsCache), mCache(PROVIDER_ID, cCacheMaxSize) {
   mThumbnailsPath = ::Utils::coreStringToAppString(Paths::getThumbnailsDirPath());
 }
 
-QImage ThumbnailProvider::requestImage (const QString &id, QSize *size, const QSize &) {
-  QImage image(mThumbnailsPath + id);
+QImage ThumbnailProvider::requestImage (const QString &id, QSize *size, const QSize &requestedSize) {
+  if (mThumbnailsCache)
+    mThumbnailsCache->touch(id);
+
+  QImage image = mCache.load(mThumbnailsPath + id, requestedSize);
   *size = image.size();
   return image;
 }
@@ -25,19 +25,35 @@
 
 #include <QQuickImageProvider>
 
+#include "ScaledImageCache.hpp"
+
 // =============================================================================
 
+class ThumbnailsCache;
+
 class ThumbnailProvider : public QQuickImageProvider {
 public:
-  ThumbnailProvider ();
+  ThumbnailProvider (ThumbnailsCache *thumbnailsCache);
   ~ThumbnailProvider () = default;
 
   QImage requestImage (const QString &id, QSize *size, const QSize &requestedSize) override;
 
   static const QString PROVIDER_ID;
 
+  int getCacheHits () const {
+    return mCache.getHits();
+  }
+
+  int getCacheMisses () const {
+    return mCache.getMisses();
+  }
+
 private:
+  // Used in the image loader thread, `ThumbnailsCache` is thread-safe.
+  ThumbnailsCache *mThumbnailsCache = nullptr;
+
   QString mThumbnailsPath;
+  ScaledImageCache mCache;
 };
 
 #endif // THUMBNAIL_PROVIDER_H_
@@ -21,26 +21,25 @@
  */
 
 #include <algorithm>
+#include <limits>
 
 #include <QDateTime>
 #include <QDesktopServices>
 #include <QFileInfo>
+#include <QSet>
 #include <QTimer>
-#include <QUuid>
 #include <QMimeDatabase>
 
 #include "../../app/App.hpp"
 #include "../../app/paths/Paths.hpp"
 #include "../../app/providers/ThumbnailProvider.hpp"
 #include "../../utils/Utils.hpp"
-#include "../../utils/QExifImageHeader.h"
 #include "../core/CoreManager.hpp"
+#include "ThumbnailGenerator.hpp"
+#include "ThumbnailsCache.hpp"
 
 #include "ChatModel.hpp"
 
-#define THUMBNAIL_IMAGE_FILE_HEIGHT 100
-#define THUMBNAIL_IMAGE_FILE_WIDTH 100
-
 // Not enabled by default.
 #ifndef LIMIT_FILE_SIZE
   #define LIMIT_FILE_SIZE 0
@@ -53,6 +52,21 @@ using namespace std;
 
 // =============================================================================
 
+namespace {
+  // Number of messages fetched from the history per page.
+  constexpr int cEntriesPageSize = 50;
+
+  // Memory budget. Above this number of entries, the pages far from the
+  // loaded one are evicted. (The newest while scrolling up in the history,
+  // the oldest while scrolling down.)
+  constexpr int cMaxLoadedEntries = 1000;
+
+  // Default interval between two file transfer progress notifications. (About one frame.)
+  constexpr int cDefaultFileTransferProgressInterval = 16;
+}
+
+// -----------------------------------------------------------------------------
+
 static inline QString getFileId (const shared_ptr<linphone::ChatMessage> &message) {
   return ::Utils::coreStringToAppString(message->getAppdata()).section(':', 0, 0);
 }
@@ -66,67 +80,52 @@ static inline bool fileWasDownloaded (const shared_ptr<linphone::ChatMessage> &m
   return !path.isEmpty() && QFileInfo(path).isFile();
 }
 
-static inline void fillThumbnailProperty (QVariantMap &dest, const shared_ptr<linphone::ChatMessage> &message) {
+// The downloaded file of an incoming message, or the sent file.
+static inline QString getLocalFilePath (const shared_ptr<linphone::ChatMessage> &message) {
+  const QString path = ::getDownloadPath(message);
+  return path.isEmpty() ? ::Utils::coreStringToAppString(message->getFileTransferFilepath()) : path;
+}
+
+static inline void fillThumbnailProperty (ChatModel::ChatEntryData &dest, const shared_ptr<linphone::ChatMessage> &message) {
   QString fileId = ::getFileId(message);
-  if (!fileId.isEmpty() && !dest.contains("thumbnail"))
-    dest["thumbnail"] = QStringLiteral("image://%1/%2")
+  if (
+    !fileId.isEmpty() && dest.thumbnail.isEmpty() &&
+    CoreManager::getInstance()->getThumbnailsCache()->contains(fileId)
+  )
+    dest.thumbnail = QStringLiteral("image://%1/%2")
       .arg(ThumbnailProvider::PROVIDER_ID).arg(fileId);
 }
 
-static inline void createThumbnail (const shared_ptr<linphone::ChatMessage> &message) {
-  if (!message->getAppdata().empty())
-    return;
-
-  QString thumbnailPath = ::Utils::coreStringToAppString(message->getFileTransferFilepath());
-  QImage image(thumbnailPath);
-  if (image.isNull())
-    return;
-
-  int rotation = 0;
-  QExifImageHeader exifImageHeader;
-  if (exifImageHeader.loadFromJpeg(thumbnailPath))
-    rotation = int(exifImageHeader.value(QExifImageHeader::ImageTag::Orientation).toShort());
-
-  QImage thumbnail = image.scaled(
-      THUMBNAIL_IMAGE_FILE_WIDTH, THUMBNAIL_IMAGE_FILE_HEIGHT,
-      Qt::KeepAspectRatio, Qt::SmoothTransformation
-    );
+static inline bool isDisplayedCall (const shared_ptr<linphone::CallLog> &callLog) {
+  switch (callLog->getStatus()) {
+    case linphone::CallStatusAborted:
+    case linphone::CallStatusEarlyAborted:
+      return false; // Ignore aborted calls.
 
-  if (rotation != 0) {
-    QTransform transform;
-    if (rotation == 3 || rotation == 4)
-      transform.rotate(180);
-    else if (rotation == 5 || rotation == 6)
-      transform.rotate(90);
-    else if (rotation == 7 || rotation == 8)
-      transform.rotate(-90);
+    case linphone::CallStatusAcceptedElsewhere:
+    case linphone::CallStatusDeclinedElsewhere:
+      return false; // Ignore accepted calls on other device.
 
-    thumbnail = thumbnail.transformed(transform);
-    if (rotation == 2 || rotation == 4 || rotation == 5 || rotation == 7)
-      thumbnail = thumbnail.mirrored(true, false);
+    case linphone::CallStatusSuccess:
+    case linphone::CallStatusMissed:
+    case linphone::CallStatusDeclined:
+      break;
   }
 
-  QString uuid = QUuid::createUuid().toString();
-  QString fileId = QStringLiteral("%1.jpg").arg(uuid.mid(1, uuid.length() - 2));
-
-  if (!thumbnail.save(::Utils::coreStringToAppString(Paths::getThumbnailsDirPath()) + fileId, "jpg", 100)) {
-    qWarning() << QStringLiteral("Unable to create thumbnail of: `%1`.").arg(thumbnailPath);
-    return;
-  }
+  return true;
+}
 
-  message->setAppdata(::Utils::appStringToCoreString(fileId));
+static inline bool isOlderEntry (const ChatModel::ChatEntryData &a, const ChatModel::ChatEntryData &b) {
+  return a.timestamp < b.timestamp;
 }
 
 static inline void removeFileMessageThumbnail (const shared_ptr<linphone::ChatMessage> &message) {
   if (message && message->getFileTransferInformation()) {
     message->cancelFileTransfer();
 
-    string fileId = message->getAppdata();
-    if (!fileId.empty()) {
-      QString thumbnailPath = ::Utils::coreStringToAppString(Paths::getThumbnailsDirPath() + fileId);
-      if (!QFile::remove(thumbnailPath))
-        qWarning() << QStringLiteral("Unable to remove `%1`.").arg(thumbnailPath);
-    }
+    QString fileId = ::getFileId(message);
+    if (!fileId.isEmpty())
+      CoreManager::getInstance()->getThumbnailsCache()->release(fileId);
   }
 }
 
@@ -141,14 +140,7 @@ public:
   ~MessageHandlers () = default;
 
 private:
-  QList<ChatEntryData>::iterator findMessageEntry (const shared_ptr<linphone::ChatMessage> &message) {
-    return find_if(mChatModel->mEntries.begin(), mChatModel->mEntries.end(), [&message](const ChatEntryData &pair) {
-        return pair.second == message;
-      });
-  }
-
-  void signalDataChanged (const QList<ChatEntryData>::iterator &it) {
-    int row = int(distance(mChatModel->mEntries.begin(), it));
+  void signalDataChanged (int row) {
     emit mChatModel->dataChanged(mChatModel->index(row, 0), mChatModel->index(row, 0));
   }
 
@@ -171,39 +163,46 @@ private:
     if (!mChatModel)
       return;
 
-    auto it = findMessageEntry(message);
-    if (it == mChatModel->mEntries.end())
+    int row = mChatModel->findMessageRow(message);
+    if (row < 0)
       return;
 
-    (*it).first["fileOffset"] = quint64(offset);
+    mChatModel->mEntries[row].fileOffset = quint64(offset);
+
+    // Transfers are driven by the iterate calls.
+    CoreManager::getInstance()->notifyCoreActivity();
 
-    signalDataChanged(it);
+    // Notified later, with the other transfers.
+    mChatModel->mPendingProgressMessages[message.get()] = message;
+    if (!mChatModel->mProgressTimer->isActive())
+      mChatModel->mProgressTimer->start();
   }
 
   void onMsgStateChanged (const shared_ptr<linphone::ChatMessage> &message, linphone::ChatMessageState state) override {
     if (!mChatModel)
       return;
 
-    auto it = findMessageEntry(message);
-    if (it == mChatModel->mEntries.end())
+    int row = mChatModel->findMessageRow(message);
+    if (row < 0)
       return;
 
+    ChatEntryData &entry = mChatModel->mEntries[row];
+
     // File message downloaded.
     if (state == linphone::ChatMessageStateFileTransferDone && !message->isOutgoing()) {
-      ::createThumbnail(message);
-      ::fillThumbnailProperty((*it).first, message);
+      mChatModel->createThumbnail(message);
 
       message->setAppdata(
         ::Utils::appStringToCoreString(::getFileId(message)) + ':' + message->getFileTransferFilepath()
       );
-      (*it).first["wasDownloaded"] = true;
+      entry.wasDownloaded = true;
 
       App::getInstance()->getNotifier()->notifyReceivedFileMessage(message);
     }
 
-    (*it).first["status"] = state;
+    entry.status = state;
 
-    signalDataChanged(it);
+    signalDataChanged(row);
   }
 
   ChatModel *mChatModel;
@@ -217,24 +216,44 @@ ChatModel::ChatModel (const QString &sipAddress) {
   mCoreHandlers = core->getHandlers();
   mMessageHandlers = make_shared<MessageHandlers>(this);
 
-  setSipAddress(sipAddress);
+  mProgressTimer = new QTimer(this);
+  mProgressTimer->setSingleShot(true);
+  mProgressTimer->setInterval(core->getCore()->getConfig()->getInt(
+    SettingsModel::UI_SECTION, "file_transfer_progress_interval", cDefaultFileTransferProgressInterval
+  ));
+  QObject::connect(mProgressTimer, &QTimer::timeout, this, &ChatModel::handleProgressTimeout);
 
-  {
-    CoreHandlers *coreHandlers = mCoreHandlers.get();
-    QObject::connect(coreHandlers, &CoreHandlers::messageReceived, this, &ChatModel::handleMessageReceived);
-    QObject::connect(coreHandlers, &CoreHandlers::callStateChanged, this, &ChatModel::handleCallStateChanged);
-    QObject::connect(coreHandlers, &CoreHandlers::isComposingChanged, this, &ChatModel::handleIsComposingChanged);
-  }
+  mThumbnailGenerator = core->getThumbnailGenerator();
+  QObject::connect(mThumbnailGenerator, &ThumbnailGenerator::thumbnailCreated, this, &ChatModel::handleThumbnailCreated);
+  QObject::connect(mThumbnailGenerator, &ThumbnailGenerator::thumbnailFailed, this, &ChatModel::handleThumbnailFailed);
+
+  // The core events of this chat room are routed by `CoreManager`.
+  setSipAddress(sipAddress);
 }
 
 ChatModel::~ChatModel () {
   mMessageHandlers->mChatModel = nullptr;
+
+  // The generator is shared, the thumbnails of the canceled jobs are released by it.
+  for (auto it = mPendingThumbnails.cbegin(); it != mPendingThumbnails.cend(); ++it)
+    mThumbnailGenerator->cancelJob(it.key());
 }
 
 QHash<int, QByteArray> ChatModel::roleNames () const {
   QHash<int, QByteArray> roles;
   roles[Roles::ChatEntry] = "$chatEntry";
   roles[Roles::SectionDate] = "$sectionDate";
+  roles[Roles::Type] = "$type";
+  roles[Roles::Timestamp] = "$timestamp";
+  roles[Roles::Content] = "$content";
+  roles[Roles::IsOutgoing] = "$isOutgoing";
+  roles[Roles::Status] = "$status";
+  roles[Roles::IsStart] = "$isStart";
+  roles[Roles::FileName] = "$fileName";
+  roles[Roles::FileSize] = "$fileSize";
+  roles[Roles::FileOffset] = "$fileOffset";
+  roles[Roles::WasDownloaded] = "$wasDownloaded";
+  roles[Roles::Thumbnail] = "$thumbnail";
   return roles;
 }
 
@@ -248,11 +267,35 @@ QVariant ChatModel::data (const QModelIndex &index, int role) const {
   if (!index.isValid() || row < 0 || row >= mEntries.count())
     return QVariant();
 
+  const ChatEntryData &entry = mEntries[row];
+
   switch (role) {
     case Roles::ChatEntry:
-      return QVariant::fromValue(mEntries[row].first);
+      return toVariantMap(entry);
     case Roles::SectionDate:
-      return QVariant::fromValue(mEntries[row].first["timestamp"].toDate());
+      return QVariant::fromValue(QDateTime::fromMSecsSinceEpoch(entry.timestamp).date());
+    case Roles::Type:
+      return entry.type;
+    case Roles::Timestamp:
+      return QDateTime::fromMSecsSinceEpoch(entry.timestamp);
+    case Roles::Content:
+      return entry.content;
+    case Roles::IsOutgoing:
+      return entry.isOutgoing;
+    case Roles::Status:
+      return entry.status;
+    case Roles::IsStart:
+      return entry.isStart;
+    case Roles::FileName:
+      return entry.fileName;
+    case Roles::FileSize:
+      return entry.fileSize;
+    case Roles::FileOffset:
+      return entry.fileOffset;
+    case Roles::WasDownloaded:
+      return entry.wasDownloaded;
+    case Roles::Thumbnail:
+      return entry.thumbnail;
   }
 
   return QVariant();
@@ -274,6 +317,7 @@ bool ChatModel::removeRows (int row, int count, const QModelIndex &parent) {
     removeEntry(mEntries[row]);
     mEntries.removeAt(row);
   }
+  rebuildMessagesIndex();
 
   endRemoveRows();
 
@@ -295,25 +339,9 @@ void ChatModel::setSipAddress (const QString &sipAddress) {
   mChatRoom = core->getChatRoomFromUri(::Utils::appStringToCoreString(sipAddress));
   Q_CHECK_PTR(mChatRoom.get());
 
-  handleIsComposingChanged(mChatRoom);
-
-  // Get messages.
-  for (auto &message : mChatRoom->getHistory(0)) {
-    QVariantMap map;
-
-    fillMessageEntry(map, message);
-
-    // Old workaround.
-    // It can exist messages with a not delivered status. It's a linphone core bug.
-    if (message->getState() == linphone::ChatMessageStateInProgress)
-      map["status"] = linphone::ChatMessageStateNotDelivered;
+  handleIsComposingChanged();
 
-    mEntries << qMakePair(map, static_pointer_cast<void>(message));
-  }
-
-  // Get calls.
-  for (auto &callLog : core->getCallHistoryForAddress(mChatRoom->getPeerAddress()))
-    insertCall(callLog);
+  loadLastEntries();
 }
 
 bool ChatModel::getIsRemoteComposing () const {
@@ -339,6 +367,31 @@ void ChatModel::removeAllEntries () {
     removeEntry(entry);
 
   mEntries.clear();
+  rebuildMessagesIndex();
+
+  for (auto it = mPendingThumbnails.cbegin(); it != mPendingThumbnails.cend(); ++it)
+    mThumbnailGenerator->cancelJob(it.key());
+  mPendingThumbnails.clear();
+
+  // Remove the entries which are not loaded. A call has two entries (start/end).
+  shared_ptr<linphone::Core> core = CoreManager::getInstance()->getCore();
+  QSet<const void *> removedCallLogs;
+  for (const auto &entry : mOlderCallEntries + mNewerCallEntries)
+    if (!removedCallLogs.contains(entry.linphonePtr.get())) {
+      removedCallLogs << entry.linphonePtr.get();
+      core->removeCallLog(static_pointer_cast<linphone::CallLog>(entry.linphonePtr));
+    }
+  mOlderCallEntries.clear();
+  mNewerCallEntries.clear();
+
+  for (int count = mChatRoom->getHistorySize(), begin = 0; begin < count; begin += cEntriesPageSize)
+    for (const auto &message : mChatRoom->getHistoryRange(begin, min(begin + cEntriesPageSize, count) - 1))
+      ::removeFileMessageThumbnail(message);
+
+  mChatRoom->deleteHistory();
+  CoreManager::getInstance()->notifyMessagesRemoved();
+  mLoadedMessagesCount = 0;
+  mNewerMessagesCount = 0;
 
   endResetModel();
 
@@ -347,12 +400,70 @@ void ChatModel::removeAllEntries () {
 
 // -----------------------------------------------------------------------------
 
+int ChatModel::loadMoreEntries () {
+  QVector<ChatEntryData> page = fetchPreviousPage();
+
+  int count = page.count();
+  if (count == 0)
+    return 0;
+
+  beginInsertRows(QModelIndex(), 0, count - 1);
+  mEntries = page + mEntries;
+
+  // Existing rows are shifted. Only the new rows must be indexed.
+  mMessagesIndexOffset += count;
+  indexMessages(0, count - 1);
+  endInsertRows();
+
+  evictNewerEntries();
+
+  return count;
+}
+
+int ChatModel::loadNewerEntries () {
+  QVector<ChatEntryData> page = fetchNextPage();
+
+  int count = page.count();
+  if (count == 0)
+    return 0;
+
+  const int first = mEntries.count();
+  beginInsertRows(QModelIndex(), first, first + count - 1);
+  mEntries += page;
+  indexMessages(first, first + count - 1);
+  endInsertRows();
+
+  evictOlderEntries();
+
+  return count;
+}
+
+bool ChatModel::hasNewerEntries () const {
+  return mNewerMessagesCount > 0 || !mNewerCallEntries.isEmpty();
+}
+
+void ChatModel::evictEntries () {
+  if (mEntries.count() <= cMaxLoadedEntries && !hasNewerEntries())
+    return;
+
+  qInfo() << QStringLiteral("Evict %1 loaded chat entries of: %2.").arg(mEntries.count()).arg(getSipAddress());
+
+  beginResetModel();
+  loadLastEntries();
+  endResetModel();
+}
+
+// -----------------------------------------------------------------------------
+
 void ChatModel::sendMessage (const QString &message) {
+  evictEntries();
+
   shared_ptr<linphone::ChatMessage> _message = mChatRoom->createMessage(::Utils::appStringToCoreString(message));
   _message->setListener(mMessageHandlers);
 
   insertMessageAtEnd(_message);
   mChatRoom->sendChatMessage(_message);
+  CoreManager::getInstance()->notifyCoreActivity();
 
   emit messageSent(_message);
 }
@@ -363,18 +474,16 @@ void ChatModel::resendMessage (int id) {
     return;
   }
 
-  const ChatEntryData entry = mEntries[id];
-  const QVariantMap map = entry.first;
-
-  if (map["type"] != EntryType::MessageEntry) {
+  const ChatEntryData &entry = mEntries[id];
+  if (entry.type != EntryType::MessageEntry) {
     qWarning() << QStringLiteral("Unable to resend entry %1. It's not a message.").arg(id);
     return;
   }
 
-  switch (map["status"].toInt()) {
+  switch (entry.status) {
     case MessageStatusFileTransferError:
     case MessageStatusNotDelivered: {
-      shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.second);
+      shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.linphonePtr);
       message->setListener(mMessageHandlers);
       message->resend();
 
@@ -414,14 +523,17 @@ void ChatModel::sendFileMessage (const QString &path) {
   content->setSize(size_t(fileSize));
   content->setName(::Utils::appStringToCoreString(QFileInfo(file).fileName()));
 
+  evictEntries();
+
   shared_ptr<linphone::ChatMessage> message = mChatRoom->createFileTransferMessage(content);
   message->setFileTransferFilepath(::Utils::appStringToCoreString(path));
   message->setListener(mMessageHandlers);
 
-  ::createThumbnail(message);
+  createThumbnail(message);
 
   insertMessageAtEnd(message);
   mChatRoom->sendChatMessage(message);
+  CoreManager::getInstance()->notifyCoreActivity();
 
   emit messageSent(message);
 }
@@ -430,10 +542,10 @@ void ChatModel::sendFileMessage (const QString &path) {
 
 void ChatModel::downloadFile (int id) {
   const ChatEntryData entry = getFileMessageEntry(id);
-  if (!entry.second)
+  if (!entry.linphonePtr)
     return;
 
-  shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.second);
+  shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.linphonePtr);
 
   switch (message->getState()) {
     case MessageStatusDelivered:
@@ -451,7 +563,7 @@ void ChatModel::downloadFile (int id) {
   const QString safeFilePath = ::Utils::getSafeFilePath(
       QStringLiteral("%1%2")
       .arg(CoreManager::getInstance()->getSettingsModel()->getDownloadFolder())
-      .arg(entry.first["fileName"].toString()),
+      .arg(entry.fileName),
       &soFarSoGood
     );
 
@@ -465,14 +577,16 @@ void ChatModel::downloadFile (int id) {
 
   if (message->downloadFile() < 0)
     qWarning() << QStringLiteral("Unable to download file of entry %1.").arg(id);
+  else
+    CoreManager::getInstance()->notifyCoreActivity();
 }
 
 void ChatModel::openFile (int id, bool showDirectory) {
   const ChatEntryData entry = getFileMessageEntry(id);
-  if (!entry.second)
+  if (!entry.linphonePtr)
     return;
 
-  shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.second);
+  shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.linphonePtr);
   if (!::fileWasDownloaded(message)) {
     downloadFile(id);
     return;
@@ -486,7 +600,7 @@ void ChatModel::openFile (int id, bool showDirectory) {
 
 bool ChatModel::fileWasDownloaded (int id) {
   const ChatEntryData entry = getFileMessageEntry(id);
-  return entry.second && ::fileWasDownloaded(static_pointer_cast<linphone::ChatMessage>(entry.second));
+  return entry.linphonePtr && ::fileWasDownloaded(static_pointer_cast<linphone::ChatMessage>(entry.linphonePtr));
 }
 
 void ChatModel::compose () {
@@ -508,13 +622,13 @@ const ChatModel::ChatEntryData ChatModel::getFileMessageEntry (int id) {
     return ChatEntryData();
   }
 
-  const ChatEntryData entry = mEntries[id];
-  if (entry.first["type"] != EntryType::MessageEntry) {
+  const ChatEntryData &entry = mEntries[id];
+  if (entry.type != EntryType::MessageEntry) {
     qWarning() << QStringLiteral("Unable to download entry %1. It's not a message.").arg(id);
     return ChatEntryData();
   }
 
-  shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.second);
+  shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.linphonePtr);
   if (!message->getFileTransferInformation()) {
     qWarning() << QStringLiteral("Entry %1 is not a file message.").arg(id);
     return ChatEntryData();
@@ -525,65 +639,264 @@ const ChatModel::ChatEntryData ChatModel::getFileMessageEntry (int id) {
 
 // -----------------------------------------------------------------------------
 
-void ChatModel::fillMessageEntry (QVariantMap &dest, const shared_ptr<linphone::ChatMessage> &message) {
-  dest["type"] = EntryType::MessageEntry;
-  dest["timestamp"] = QDateTime::fromMSecsSinceEpoch(message->getTime() * 1000);
-  dest["content"] = ::Utils::coreStringToAppString(message->getText());
-  dest["isOutgoing"] = message->isOutgoing() || message->getState() == linphone::ChatMessageStateIdle;
-  dest["status"] = message->getState();
+void ChatModel::loadLastEntries () {
+  mEntries.clear();
+  mLoadedMessagesCount = 0;
+  mNewerMessagesCount = 0;
+
+  // Get calls. They are merged with the messages page per page.
+  {
+    list<shared_ptr<linphone::CallLog> > callLogs = CoreManager::getInstance()->getCore()->getCallHistoryForAddress(
+      mChatRoom->getPeerAddress()
+    );
+
+    mOlderCallEntries.clear();
+    mNewerCallEntries.clear();
+    for (const auto &callLog : callLogs) {
+      if (!::isDisplayedCall(callLog))
+        continue;
+
+      ChatEntryData start;
+      fillCallStartEntry(start, callLog);
+      mOlderCallEntries << start;
+
+      if (callLog->getStatus() == linphone::CallStatusSuccess) {
+        ChatEntryData end;
+        fillCallEndEntry(end, callLog);
+        mOlderCallEntries << end;
+      }
+    }
+
+    stable_sort(mOlderCallEntries.begin(), mOlderCallEntries.end(), ::isOlderEntry);
+  }
+
+  mEntries = fetchPreviousPage();
+  rebuildMessagesIndex();
+}
+
+QVector<ChatModel::ChatEntryData> ChatModel::fetchPreviousPage () {
+  QVector<ChatEntryData> page;
+
+  // 1. Get the previous messages. Index 0 is the most recent message of the history.
+  const int historySize = mChatRoom->getHistorySize();
+  if (mLoadedMessagesCount < historySize) {
+    const int end = min(mLoadedMessagesCount + cEntriesPageSize, historySize) - 1;
+
+    list<shared_ptr<linphone::ChatMessage> > messages = mChatRoom->getHistoryRange(mLoadedMessagesCount, end);
+    page.reserve(int(messages.size()));
+
+    for (auto &message : messages) {
+      ChatEntryData entry;
+
+      fillMessageEntry(entry, message);
+
+      // Old workaround.
+      // It can exist messages with a not delivered status. It's a linphone core bug.
+      if (message->getState() == linphone::ChatMessageStateInProgress)
+        entry.status = linphone::ChatMessageStateNotDelivered;
+
+      page << entry;
+    }
+
+    // Avoid an infinite loading if the history is not readable.
+    mLoadedMessagesCount = page.isEmpty() ? historySize : end + 1;
+  }
+
+  // 2. Merge the calls which are more recent than the oldest fetched message.
+  // All remaining calls are merged if the history is fully loaded.
+  const qint64 limit = mLoadedMessagesCount < historySize && !page.isEmpty()
+    ? page.first().timestamp
+    : 0;
+
+  while (!mOlderCallEntries.isEmpty() && mOlderCallEntries.last().timestamp >= limit)
+    page << mOlderCallEntries.takeLast();
+
+  stable_sort(page.begin(), page.end(), ::isOlderEntry);
+
+  return page;
+}
+
+QVector<ChatModel::ChatEntryData> ChatModel::fetchNextPage () {
+  QVector<ChatEntryData> page;
+
+  // 1. Get the next messages. They are just before the loaded messages in the history.
+  if (mNewerMessagesCount > 0) {
+    const int begin = max(mNewerMessagesCount - cEntriesPageSize, 0);
+
+    list<shared_ptr<linphone::ChatMessage> > messages = mChatRoom->getHistoryRange(begin, mNewerMessagesCount - 1);
+    page.reserve(int(messages.size()));
+
+    for (auto &message : messages) {
+      ChatEntryData entry;
+
+      fillMessageEntry(entry, message);
+
+      // Same workaround as the previous pages.
+      if (message->getState() == linphone::ChatMessageStateInProgress)
+        entry.status = linphone::ChatMessageStateNotDelivered;
+
+      page << entry;
+    }
+
+    // Avoid an infinite loading if the history is not readable.
+    mNewerMessagesCount = page.isEmpty() ? 0 : begin;
+  }
+
+  // 2. Merge the calls which are older than the newest fetched message.
+  // All remaining calls are merged if the newest message is loaded.
+  const qint64 limit = mNewerMessagesCount > 0 && !page.isEmpty()
+    ? page.last().timestamp
+    : numeric_limits<qint64>::max();
+
+  while (!mNewerCallEntries.isEmpty() && mNewerCallEntries.first().timestamp <= limit)
+    page << mNewerCallEntries.takeFirst();
+
+  stable_sort(page.begin(), page.end(), ::isOlderEntry);
+
+  return page;
+}
+
+void ChatModel::evictNewerEntries () {
+  const int count = mEntries.count() - cMaxLoadedEntries;
+  if (count <= 0)
+    return;
+
+  const int first = mEntries.count() - count;
+  beginRemoveRows(QModelIndex(), first, mEntries.count() - 1);
+
+  for (int row = mEntries.count() - 1; row >= first; --row) {
+    const ChatEntryData &entry = mEntries[row];
+    if (entry.type == EntryType::MessageEntry) {
+      mMessagesIndex.remove(static_cast<const linphone::ChatMessage *>(entry.linphonePtr.get()));
+      ++mNewerMessagesCount;
+    } else
+      mNewerCallEntries.prepend(entry);
+  }
+  mEntries.remove(first, count);
+
+  endRemoveRows();
+}
+
+void ChatModel::evictOlderEntries () {
+  const int count = mEntries.count() - cMaxLoadedEntries;
+  if (count <= 0)
+    return;
+
+  beginRemoveRows(QModelIndex(), 0, count - 1);
+
+  for (int row = 0; row < count; ++row) {
+    const ChatEntryData &entry = mEntries[row];
+    if (entry.type == EntryType::MessageEntry) {
+      mMessagesIndex.remove(static_cast<const linphone::ChatMessage *>(entry.linphonePtr.get()));
+      --mLoadedMessagesCount;
+    } else
+      mOlderCallEntries << entry;
+  }
+  mEntries.remove(0, count);
+
+  // The next rows are shifted.
+  mMessagesIndexOffset -= count;
+
+  endRemoveRows();
+}
+
+// -----------------------------------------------------------------------------
+
+void ChatModel::fillMessageEntry (ChatEntryData &dest, const shared_ptr<linphone::ChatMessage> &message) {
+  dest.type = EntryType::MessageEntry;
+  dest.timestamp = qint64(message->getTime()) * 1000;
+  dest.content = ::Utils::coreStringToAppString(message->getText());
+  dest.isOutgoing = message->isOutgoing() || message->getState() == linphone::ChatMessageStateIdle;
+  dest.status = message->getState();
+  dest.linphonePtr = message;
 
   shared_ptr<const linphone::Content> content = message->getFileTransferInformation();
   if (content) {
-    dest["fileSize"] = quint64(content->getSize());
-    dest["fileName"] = ::Utils::coreStringToAppString(content->getName());
-    dest["wasDownloaded"] = ::fileWasDownloaded(message);
+    dest.fileSize = quint64(content->getSize());
+    dest.fileName = ::Utils::coreStringToAppString(content->getName());
+    dest.wasDownloaded = ::fileWasDownloaded(message);
 
     ::fillThumbnailProperty(dest, message);
+
+    // The app was closed before the creation of the thumbnail.
+    if (
+      dest.thumbnail.isEmpty() &&
+      content->getType() == "image" &&
+      QFileInfo(::getLocalFilePath(message)).isFile()
+    )
+      createThumbnail(message);
   }
 }
 
-void ChatModel::fillCallStartEntry (QVariantMap &dest, const shared_ptr<linphone::CallLog> &callLog) {
-  QDateTime timestamp = QDateTime::fromMSecsSinceEpoch(callLog->getStartDate() * 1000);
+void ChatModel::fillCallStartEntry (ChatEntryData &dest, const shared_ptr<linphone::CallLog> &callLog) {
+  dest.type = EntryType::CallEntry;
+  dest.timestamp = qint64(callLog->getStartDate()) * 1000;
+  dest.isOutgoing = callLog->getDir() == linphone::CallDirOutgoing;
+  dest.status = callLog->getStatus();
+  dest.isStart = true;
+  dest.linphonePtr = callLog;
+}
 
-  dest["type"] = EntryType::CallEntry;
-  dest["timestamp"] = timestamp;
-  dest["isOutgoing"] = callLog->getDir() == linphone::CallDirOutgoing;
-  dest["status"] = callLog->getStatus();
-  dest["isStart"] = true;
+void ChatModel::fillCallEndEntry (ChatEntryData &dest, const shared_ptr<linphone::CallLog> &callLog) {
+  dest.type = EntryType::CallEntry;
+  dest.timestamp = (qint64(callLog->getStartDate()) + callLog->getDuration()) * 1000;
+  dest.isOutgoing = callLog->getDir() == linphone::CallDirOutgoing;
+  dest.status = callLog->getStatus();
+  dest.isStart = false;
+  dest.linphonePtr = callLog;
 }
 
-void ChatModel::fillCallEndEntry (QVariantMap &dest, const shared_ptr<linphone::CallLog> &callLog) {
-  QDateTime timestamp = QDateTime::fromMSecsSinceEpoch((callLog->getStartDate() + callLog->getDuration()) * 1000);
+QVariantMap ChatModel::toVariantMap (const ChatEntryData &entry) {
+  QVariantMap map;
+
+  map["type"] = entry.type;
+  map["timestamp"] = QDateTime::fromMSecsSinceEpoch(entry.timestamp);
+  map["isOutgoing"] = entry.isOutgoing;
+  map["status"] = entry.status;
 
-  dest["type"] = EntryType::CallEntry;
-  dest["timestamp"] = timestamp;
-  dest["isOutgoing"] = callLog->getDir() == linphone::CallDirOutgoing;
-  dest["status"] = callLog->getStatus();
-  dest["isStart"] = false;
+  if (entry.type == EntryType::CallEntry) {
+    map["isStart"] = entry.isStart;
+    return map;
+  }
+
+  map["content"] = entry.content;
+  if (!entry.fileName.isEmpty()) {
+    map["fileSize"] = entry.fileSize;
+    map["fileOffset"] = entry.fileOffset;
+    map["fileName"] = entry.fileName;
+    map["wasDownloaded"] = entry.wasDownloaded;
+    if (!entry.thumbnail.isEmpty())
+      map["thumbnail"] = entry.thumbnail;
+  }
+
+  return map;
 }
 
 // -----------------------------------------------------------------------------
 
-void ChatModel::removeEntry (ChatEntryData &pair) {
-  int type = pair.first["type"].toInt();
+void ChatModel::removeEntry (ChatEntryData &entry) {
+  int type = entry.type;
 
   switch (type) {
     case ChatModel::MessageEntry: {
-      shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(pair.second);
+      shared_ptr<linphone::ChatMessage> message = static_pointer_cast<linphone::ChatMessage>(entry.linphonePtr);
+      cancelThumbnail(message);
       ::removeFileMessageThumbnail(message);
       mChatRoom->deleteMessage(message);
+      CoreManager::getInstance()->notifyMessagesRemoved();
+      --mLoadedMessagesCount;
       break;
     }
 
     case ChatModel::CallEntry: {
-      if (pair.first["status"].toInt() == linphone::CallStatusSuccess) {
+      if (entry.status == linphone::CallStatusSuccess) {
         // WARNING: Unable to remove symmetric call here. (start/end)
         // We are between `beginRemoveRows` and `endRemoveRows`.
         // A solution is to schedule a `removeEntry` call in the Qt main loop.
-        shared_ptr<void> linphonePtr = pair.second;
+        shared_ptr<void> linphonePtr = entry.linphonePtr;
         QTimer::singleShot(0, this, [this, linphonePtr]() {
-            auto it = find_if(mEntries.begin(), mEntries.end(), [linphonePtr](const ChatEntryData &pair) {
-                  return pair.second == linphonePtr;
+            auto it = find_if(mEntries.begin(), mEntries.end(), [linphonePtr](const ChatEntryData &entry) {
+                  return entry.linphonePtr == linphonePtr;
                 });
 
             if (it != mEntries.end())
@@ -591,7 +904,15 @@ void ChatModel::removeEntry (ChatEntryData &pair) {
           });
       }
 
-      CoreManager::getInstance()->getCore()->removeCallLog(static_pointer_cast<linphone::CallLog>(pair.second));
+      // The symmetric call entry can be not loaded.
+      const shared_ptr<void> linphonePtr = entry.linphonePtr;
+      auto isSameCall = [&linphonePtr](const ChatEntryData &entry) {
+          return entry.linphonePtr == linphonePtr;
+        };
+      mOlderCallEntries.erase(remove_if(mOlderCallEntries.begin(), mOlderCallEntries.end(), isSameCall), mOlderCallEntries.end());
+      mNewerCallEntries.erase(remove_if(mNewerCallEntries.begin(), mNewerCallEntries.end(), isSameCall), mNewerCallEntries.end());
+
+      CoreManager::getInstance()->getCore()->removeCallLog(static_pointer_cast<linphone::CallLog>(entry.linphonePtr));
       break;
     }
 
@@ -600,89 +921,187 @@ void ChatModel::removeEntry (ChatEntryData &pair) {
   }
 }
 
-void ChatModel::insertCall (const shared_ptr<linphone::CallLog> &callLog) {
-  linphone::CallStatus status = callLog->getStatus();
+void ChatModel::createThumbnail (const shared_ptr<linphone::ChatMessage> &message) {
+  if (!::getFileId(message).isEmpty())
+    return;
 
-  switch (status) {
-    case linphone::CallStatusAborted:
-    case linphone::CallStatusEarlyAborted:
-      return; // Ignore aborted calls.
+  const QString path = ::getLocalFilePath(message);
+  if (mFailedThumbnails.contains(path))
+    return;
 
-    case linphone::CallStatusAcceptedElsewhere:
-    case linphone::CallStatusDeclinedElsewhere:
-      return; // Ignore accepted calls on other device.
+  for (const auto &pendingMessage : mPendingThumbnails)
+    if (pendingMessage == message)
+      return; // Already in progress.
 
-    case linphone::CallStatusSuccess:
-    case linphone::CallStatusMissed:
-    case linphone::CallStatusDeclined:
-      break;
-  }
+  int jobId = mThumbnailGenerator->addJob(path);
+  if (jobId >= 0)
+    mPendingThumbnails[jobId] = message;
+}
+
+void ChatModel::cancelThumbnail (const shared_ptr<linphone::ChatMessage> &message) {
+  for (auto it = mPendingThumbnails.begin(); it != mPendingThumbnails.end(); ++it)
+    if (*it == message) {
+      mThumbnailGenerator->cancelJob(it.key());
+      mPendingThumbnails.erase(it);
+      return;
+    }
+}
 
-  auto insertEntry = [this](
-    const ChatEntryData &pair,
-    const QList<ChatEntryData>::iterator *start = NULL
-  ) {
-    auto it = lower_bound(start ? *start : mEntries.begin(), mEntries.end(), pair, [](const ChatEntryData &a, const ChatEntryData &b) {
-      return a.first["timestamp"] < b.first["timestamp"];
-    });
+// -----------------------------------------------------------------------------
+
+void ChatModel::insertCall (const shared_ptr<linphone::CallLog> &callLog) {
+  if (!::isDisplayedCall(callLog))
+    return;
+
+  linphone::CallStatus status = callLog->getStatus();
+
+  auto insertEntry = [this](const ChatEntryData &entry, int startRow = 0) {
+    // The newest entries are not loaded, the entry is merged later if it's more recent.
+    if (hasNewerEntries() && (mEntries.isEmpty() || mEntries.last().timestamp < entry.timestamp)) {
+      mNewerCallEntries.insert(
+        upper_bound(mNewerCallEntries.begin(), mNewerCallEntries.end(), entry, ::isOlderEntry),
+        entry
+      );
+      return int(mEntries.count());
+    }
+
+    auto it = lower_bound(mEntries.begin() + startRow, mEntries.end(), entry, ::isOlderEntry);
 
     int row = int(distance(mEntries.begin(), it));
 
     beginInsertRows(QModelIndex(), row, row);
-    it = mEntries.insert(it, pair);
+    mEntries.insert(row, entry);
+
+    // Calls are not indexed but the next messages are shifted.
+    if (row < mEntries.count() - 1)
+      rebuildMessagesIndex();
     endInsertRows();
 
-    return it;
+    return row;
   };
 
   // Add start call.
-  QVariantMap start;
+  ChatEntryData start;
   fillCallStartEntry(start, callLog);
-  auto it = insertEntry(qMakePair(start, static_pointer_cast<void>(callLog)));
+  int row = insertEntry(start);
 
   // Add end call. (if necessary)
   if (status == linphone::CallStatusSuccess) {
-    QVariantMap end;
+    ChatEntryData end;
     fillCallEndEntry(end, callLog);
-    insertEntry(qMakePair(end, static_pointer_cast<void>(callLog)), &it);
+    insertEntry(end, row);
   }
 }
 
 void ChatModel::insertMessageAtEnd (const shared_ptr<linphone::ChatMessage> &message) {
+  // The newest entries are not loaded. The message is the first of the history,
+  // so the loaded messages are shifted.
+  if (hasNewerEntries()) {
+    ++mNewerMessagesCount;
+    ++mLoadedMessagesCount;
+    return;
+  }
+
   int row = mEntries.count();
 
   beginInsertRows(QModelIndex(), row, row);
 
-  QVariantMap map;
-  fillMessageEntry(map, message);
-  mEntries << qMakePair(map, static_pointer_cast<void>(message));
+  ChatEntryData entry;
+  fillMessageEntry(entry, message);
+  mEntries << entry;
+  ++mLoadedMessagesCount;
+  indexMessages(row, row);
 
   endInsertRows();
 }
 
 // -----------------------------------------------------------------------------
 
+int ChatModel::findMessageRow (const shared_ptr<linphone::ChatMessage> &message) const {
+  auto it = mMessagesIndex.constFind(message.get());
+  if (it == mMessagesIndex.cend())
+    return -1;
+
+  int row = *it + mMessagesIndexOffset;
+  Q_ASSERT(row >= 0 && row < mEntries.count() && mEntries[row].linphonePtr == message);
+  return row;
+}
+
+void ChatModel::indexMessages (int first, int last) {
+  for (int row = first; row <= last; ++row) {
+    const ChatEntryData &entry = mEntries[row];
+    if (entry.type == EntryType::MessageEntry)
+      mMessagesIndex[static_cast<const linphone::ChatMessage *>(entry.linphonePtr.get())] = row - mMessagesIndexOffset;
+  }
+}
+
+void ChatModel::rebuildMessagesIndex () {
+  mMessagesIndex.clear();
+  mMessagesIndexOffset = 0;
+  indexMessages(0, mEntries.count() - 1);
+}
+
+// -----------------------------------------------------------------------------
+
+void ChatModel::handleProgressTimeout () {
+  int first = mEntries.count();
+  int last = -1;
+
+  for (const auto &message : mPendingProgressMessages) {
+    int row = findMessageRow(message);
+    if (row < 0)
+      continue; // Removed or evicted.
+
+    first = min(first, row);
+    last = max(last, row);
+  }
+  mPendingProgressMessages.clear();
+
+  if (last >= 0)
+    emit dataChanged(index(first, 0), index(last, 0), { Roles::FileOffset });
+}
+
+void ChatModel::handleThumbnailCreated (int jobId, const QString &thumbnailId) {
+  // Job of another chat model.
+  shared_ptr<linphone::ChatMessage> message = mPendingThumbnails.take(jobId);
+  if (!message)
+    return;
+
+  // The reference of the job is now owned by the message app data.
+  const QString downloadPath = ::getDownloadPath(message);
+  message->setAppdata(::Utils::appStringToCoreString(
+    downloadPath.isEmpty() ? thumbnailId : thumbnailId + ':' + downloadPath
+  ));
+
+  int row = findMessageRow(message);
+  if (row < 0)
+    return;
+
+  ::fillThumbnailProperty(mEntries[row], message);
+  emit dataChanged(index(row, 0), index(row, 0), { Roles::Thumbnail });
+}
+
+void ChatModel::handleThumbnailFailed (int jobId) {
+  // Job of another chat model.
+  shared_ptr<linphone::ChatMessage> message = mPendingThumbnails.take(jobId);
+  if (message)
+    mFailedThumbnails << ::getLocalFilePath(message);
+}
+
 void ChatModel::handleCallStateChanged (const shared_ptr<linphone::Call> &call, linphone::CallState state) {
-  if (
-    (state == linphone::CallStateEnd || state == linphone::CallStateError) &&
-    mChatRoom == CoreManager::getInstance()->getCore()->getChatRoom(call->getRemoteAddress())
-  )
+  if (state == linphone::CallStateEnd || state == linphone::CallStateError)
     insertCall(call->getCallLog());
 }
 
-void ChatModel::handleIsComposingChanged (const shared_ptr<linphone::ChatRoom> &chatRoom) {
-  if (mChatRoom == chatRoom) {
-    bool isRemoteComposing = mChatRoom->isRemoteComposing();
-    if (isRemoteComposing != mIsRemoteComposing) {
-      mIsRemoteComposing = isRemoteComposing;
-      emit isRemoteComposingChanged(mIsRemoteComposing);
-    }
+void ChatModel::handleIsComposingChanged () {
+  bool isRemoteComposing = mChatRoom->isRemoteComposing();
+  if (isRemoteComposing != mIsRemoteComposing) {
+    mIsRemoteComposing = isRemoteComposing;
+    emit isRemoteComposingChanged(mIsRemoteComposing);
   }
 }
 
 void ChatModel::handleMessageReceived (const shared_ptr<linphone::ChatMessage> &message) {
-  if (mChatRoom == message->getChatRoom()) {
-    insertMessageAtEnd(message);
-    emit messageReceived(message);
-  }
+  insertMessageAtEnd(message);
+  emit messageReceived(message);
 }
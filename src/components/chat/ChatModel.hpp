@@ -25,12 +25,15 @@
 
 #include <linphone++/linphone.hh>
 #include <QAbstractListModel>
+#include <QSet>
 
 // =============================================================================
-// Fetch all N messages of a ChatRoom.
+// Fetch the last N messages of a ChatRoom. Older pages are loaded on demand.
 // =============================================================================
 
 class CoreHandlers;
+class QTimer;
+class ThumbnailGenerator;
 
 class ChatModel : public QAbstractListModel {
   class MessageHandlers;
@@ -40,7 +43,18 @@ class ChatModel : public QAbstractListModel {
 public:
   enum Roles {
     ChatEntry = Qt::DisplayRole,
-    SectionDate
+    SectionDate,
+    Type,
+    Timestamp,
+    Content,
+    IsOutgoing,
+    Status,
+    IsStart,
+    FileName,
+    FileSize,
+    FileOffset,
+    WasDownloaded,
+    Thumbnail
   };
 
   enum EntryType {
@@ -72,6 +86,27 @@ public:
 
   Q_ENUM(MessageStatus);
 
+  // Typed chat entry. The message and file fields are not used by call entries.
+  struct ChatEntryData {
+    EntryType type = GenericEntry;
+    int status = 0;
+    bool isOutgoing = false;
+    bool isStart = false;
+    bool wasDownloaded = false;
+
+    qint64 timestamp = 0; // In milliseconds since epoch.
+
+    quint64 fileSize = 0;
+    quint64 fileOffset = 0;
+
+    QString content;
+    QString fileName;
+    QString thumbnail;
+
+    // A `linphone::ChatMessage` or a `linphone::CallLog`.
+    std::shared_ptr<void> linphonePtr;
+  };
+
   ChatModel (const QString &sipAddress);
   ~ChatModel ();
 
@@ -90,6 +125,21 @@ public:
   void removeEntry (int id);
   void removeAllEntries ();
 
+  // Load the previous page of entries (messages and calls).
+  // The newest pages are evicted if the memory budget is exceeded.
+  // Returns the number of inserted rows.
+  int loadMoreEntries ();
+
+  // Load the next page of entries if the newest pages were evicted.
+  // The oldest pages are evicted if the memory budget is exceeded.
+  // Returns the number of inserted rows.
+  int loadNewerEntries ();
+  bool hasNewerEntries () const;
+
+  // Reload the last page if the memory budget is exceeded or if the newest
+  // entries are not loaded.
+  void evictEntries ();
+
   void sendMessage (const QString &message);
 
   void resendMessage (int id);
@@ -108,6 +158,11 @@ public:
 
   void resetMessagesCount ();
 
+  // Events of this chat room, routed by `CoreManager`.
+  void handleCallStateChanged (const std::shared_ptr<linphone::Call> &call, linphone::CallState state);
+  void handleIsComposingChanged ();
+  void handleMessageReceived (const std::shared_ptr<linphone::ChatMessage> &message);
+
 signals:
   bool isRemoteComposingChanged (bool status);
 
@@ -119,30 +174,75 @@ signals:
   void messagesCountReset ();
 
 private:
-  typedef QPair<QVariantMap, std::shared_ptr<void> > ChatEntryData;
-
   void setSipAddress (const QString &sipAddress);
 
+  void loadLastEntries ();
+  QVector<ChatEntryData> fetchPreviousPage ();
+  QVector<ChatEntryData> fetchNextPage ();
+
+  void evictNewerEntries ();
+  void evictOlderEntries ();
+
   const ChatEntryData getFileMessageEntry (int id);
 
-  void fillMessageEntry (QVariantMap &dest, const std::shared_ptr<linphone::ChatMessage> &message);
-  void fillCallStartEntry (QVariantMap &dest, const std::shared_ptr<linphone::CallLog> &callLog);
-  void fillCallEndEntry (QVariantMap &dest, const std::shared_ptr<linphone::CallLog> &callLog);
+  void fillMessageEntry (ChatEntryData &dest, const std::shared_ptr<linphone::ChatMessage> &message);
+  void fillCallStartEntry (ChatEntryData &dest, const std::shared_ptr<linphone::CallLog> &callLog);
+  void fillCallEndEntry (ChatEntryData &dest, const std::shared_ptr<linphone::CallLog> &callLog);
 
-  void removeEntry (ChatEntryData &pair);
+  void removeEntry (ChatEntryData &entry);
+
+  static QVariantMap toVariantMap (const ChatEntryData &entry);
+
+  void createThumbnail (const std::shared_ptr<linphone::ChatMessage> &message);
+  void cancelThumbnail (const std::shared_ptr<linphone::ChatMessage> &message);
 
   void insertCall (const std::shared_ptr<linphone::CallLog> &callLog);
   void insertMessageAtEnd (const std::shared_ptr<linphone::ChatMessage> &message);
 
-  void handleCallStateChanged (const std::shared_ptr<linphone::Call> &call, linphone::CallState state);
-  void handleIsComposingChanged (const std::shared_ptr<linphone::ChatRoom> &chatRoom);
-  void handleMessageReceived (const std::shared_ptr<linphone::ChatMessage> &message);
+  // Returns the row of a loaded message or -1.
+  int findMessageRow (const std::shared_ptr<linphone::ChatMessage> &message) const;
+
+  void indexMessages (int first, int last);
+  void rebuildMessagesIndex ();
+
+  void handleProgressTimeout ();
+
+  void handleThumbnailCreated (int jobId, const QString &thumbnailId);
+  void handleThumbnailFailed (int jobId);
 
   bool mIsRemoteComposing = false;
 
-  QList<ChatEntryData> mEntries;
+  QVector<ChatEntryData> mEntries;
   std::shared_ptr<linphone::ChatRoom> mChatRoom;
 
+  // Message => row in `mEntries`. The real row is `index value + offset`,
+  // so prepending a page doesn't invalidate the existing values.
+  QHash<const linphone::ChatMessage *, int> mMessagesIndex;
+  int mMessagesIndexOffset = 0;
+
+  // The loaded messages are in the `[mNewerMessagesCount, mLoadedMessagesCount)`
+  // range of the history. (0 is the most recent message.)
+  int mLoadedMessagesCount = 0;
+  int mNewerMessagesCount = 0;
+
+  // Call entries (start/end) older and newer than the loaded entries. Sorted by timestamp.
+  QVector<ChatEntryData> mOlderCallEntries;
+  QVector<ChatEntryData> mNewerCallEntries;
+
+  // File transfers in progress which are not yet notified. Coalesced in one
+  // `dataChanged` of the `FileOffset` role per timer interval.
+  QHash<const linphone::ChatMessage *, std::shared_ptr<linphone::ChatMessage> > mPendingProgressMessages;
+  QTimer *mProgressTimer = nullptr;
+
+  // Thumbnail job => message. Until the creation, the file extension is displayed.
+  // The generator is shared by the chat models. (Owned by `CoreManager`.)
+  QHash<int, std::shared_ptr<linphone::ChatMessage> > mPendingThumbnails;
+  ThumbnailGenerator *mThumbnailGenerator = nullptr;
+
+  // Local files which can't be decoded. Their thumbnail is not requested
+  // again when their page is loaded.
+  QSet<QString> mFailedThumbnails;
+
   std::shared_ptr<CoreHandlers> mCoreHandlers;
   std::shared_ptr<MessageHandlers> mMessageHandlers;
 };
@@ -48,9 +48,7 @@ protected:
       return true;
 
     QModelIndex index = sourceModel()->index(sourceRow, 0, QModelIndex());
-    const QVariantMap data = index.data().toMap();
-
-    return data["type"].toInt() == mEntryTypeFilter;
+    return index.data(ChatModel::Type).toInt() == mEntryTypeFilter;
   }
 
 private:
@@ -60,6 +58,7 @@ private:
 // =============================================================================
 
 const int ChatProxyModel::ENTRIES_CHUNK_SIZE = 50;
+const int ChatProxyModel::MAX_FETCHED_PAGES = 4;
 
 ChatProxyModel::ChatProxyModel (QObject *parent) : QSortFilterProxyModel(parent) {
   setSourceModel(new ChatModelFilter(this));
@@ -110,20 +109,50 @@ CREATE_PARENT_MODEL_FUNCTION_WITH_ID(resendMessage);
 // -----------------------------------------------------------------------------
 
 void ChatProxyModel::loadMoreEntries () {
+  if (!mChatModel)
+    return;
+
+  // The newest pages can be evicted by the chat model, so the new entries
+  // are counted with the row of the oldest entry.
+  QPersistentModelIndex oldestEntry = index(0, 0);
+
   int count = rowCount();
   int parentCount = sourceModel()->rowCount();
 
+  // All loaded entries are displayed, fetch the previous pages of the chat model.
+  // With a sparse entry type filter, the next pages are fetched at the next call.
+  if (count == parentCount) {
+    QPersistentModelIndex oldestParentEntry = sourceModel()->index(0, 0);
+    for (int i = 0; i < MAX_FETCHED_PAGES; ++i) {
+      if (mChatModel->loadMoreEntries() == 0)
+        break;
+      if ((oldestParentEntry.isValid() ? oldestParentEntry.row() : sourceModel()->rowCount()) >= ENTRIES_CHUNK_SIZE)
+        break;
+    }
+    parentCount = sourceModel()->rowCount();
+  }
+
   if (count < parentCount) {
     // Do not increase `mMaxDisplayedEntries` if it's not necessary...
     // Limit qml calls.
-    if (count == mMaxDisplayedEntries)
-      mMaxDisplayedEntries += ENTRIES_CHUNK_SIZE;
+    if (count >= mMaxDisplayedEntries)
+      mMaxDisplayedEntries = count + ENTRIES_CHUNK_SIZE;
 
     invalidateFilter();
+  }
+
+  // Always notified, even without new entries, to allow the next call.
+  emit moreEntriesLoaded(oldestEntry.isValid() ? oldestEntry.row() : rowCount());
+}
 
-    count = rowCount() - count;
-    if (count > 0)
-      emit moreEntriesLoaded(count);
+void ChatProxyModel::loadNewerEntries () {
+  if (!mChatModel || !mChatModel->hasNewerEntries())
+    return;
+
+  int count = mChatModel->loadNewerEntries();
+  if (count > 0) {
+    mMaxDisplayedEntries += count;
+    invalidateFilter();
   }
 }
 
@@ -161,6 +190,7 @@ void ChatProxyModel::setSipAddress (const QString &sipAddress) {
   mChatModel = CoreManager::getInstance()->getChatModelFromSipAddress(sipAddress);
 
   if (mChatModel) {
+    mChatModel->evictEntries();
     mChatModel->resetMessagesCount();
 
     ChatModel *chatModel = mChatModel.get();
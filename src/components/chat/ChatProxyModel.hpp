@@ -41,6 +41,7 @@ public:
   ChatProxyModel (QObject *parent = Q_NULLPTR);
 
   Q_INVOKABLE void loadMoreEntries ();
+  Q_INVOKABLE void loadNewerEntries ();
   Q_INVOKABLE void setEntryTypeFilter (ChatModel::EntryType type);
   Q_INVOKABLE void removeEntry (int id);
 
@@ -83,6 +84,7 @@ private:
   std::shared_ptr<ChatModel> mChatModel;
 
   static const int ENTRIES_CHUNK_SIZE;
+  static const int MAX_FETCHED_PAGES;
 };
 
 #endif // CHAT_PROXY_MODEL_H_
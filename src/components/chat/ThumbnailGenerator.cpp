@@ -0,0 +1,180 @@
+/*
+ * ThumbnailGenerator.cpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QImageReader>
+#include <QtConcurrent>
+
+#include "ThumbnailsCache.hpp"
+
+#include "ThumbnailGenerator.hpp"
+
+#define THUMBNAIL_IMAGE_FILE_HEIGHT 100
+#define THUMBNAIL_IMAGE_FILE_WIDTH 100
+
+// =============================================================================
+
+namespace {
+  // Jobs are dropped above this limit. (The file extension is displayed instead.)
+  constexpr int cMaxPendingJobs = 32;
+}
+
+static inline qint64 getDecodeBufferSize (const QSize &size) {
+  return size.isValid() ? qint64(size.width()) * size.height() * 4 : 0;
+}
+
+// -----------------------------------------------------------------------------
+
+ThumbnailGenerator::ThumbnailGenerator (ThumbnailsCache *thumbnailsCache, QObject *parent) :
+  QObject(parent), mThumbnailsCache(thumbnailsCache) {
+  mThreadPool.setMaxThreadCount(1);
+
+  // A job is canceled or notified in the generator thread, so a thumbnail is
+  // never lost between the two.
+  QObject::connect(this, &ThumbnailGenerator::jobFinished, this, &ThumbnailGenerator::handleJobFinished, Qt::QueuedConnection);
+}
+
+ThumbnailGenerator::~ThumbnailGenerator () {
+  {
+    QMutexLocker locker(&mJobsMutex);
+    mJobs.clear();
+  }
+  mThreadPool.clear();
+  mThreadPool.waitForDone();
+}
+
+// -----------------------------------------------------------------------------
+
+int ThumbnailGenerator::addJob (const QString &imagePath) {
+  int jobId;
+  {
+    QMutexLocker locker(&mJobsMutex);
+    if (mJobs.count() >= cMaxPendingJobs) {
+      qWarning() << QStringLiteral("Too many pending thumbnails, ignore: `%1`.").arg(imagePath);
+      return -1;
+    }
+    jobId = ++mLastJobId;
+    mJobs << jobId;
+  }
+
+  QtConcurrent::run(&mThreadPool, [this, jobId, imagePath] {
+    runJob(jobId, imagePath);
+  });
+
+  return jobId;
+}
+
+void ThumbnailGenerator::cancelJob (int jobId) {
+  QMutexLocker locker(&mJobsMutex);
+  mJobs.remove(jobId);
+}
+
+int ThumbnailGenerator::getJobsCount () {
+  QMutexLocker locker(&mJobsMutex);
+  return mLastJobId;
+}
+
+bool ThumbnailGenerator::hasPendingJobs () {
+  QMutexLocker locker(&mJobsMutex);
+  return !mJobs.isEmpty();
+}
+
+// -----------------------------------------------------------------------------
+
+void ThumbnailGenerator::runJob (int jobId, const QString &imagePath) {
+  if (isCanceled(jobId))
+    return;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // Decode directly at the thumbnail size. (DCT scaling for JPEG.)
+  // The EXIF orientation is applied in the same pass.
+  QImageReader reader(imagePath);
+  reader.setAutoTransform(true);
+
+  const QSize originalSize = reader.size();
+  if (originalSize.isValid())
+    reader.setScaledSize(originalSize.scaled(
+      THUMBNAIL_IMAGE_FILE_WIDTH, THUMBNAIL_IMAGE_FILE_HEIGHT, Qt::KeepAspectRatio
+    ));
+
+  QImage thumbnail = reader.read();
+  if (thumbnail.isNull()) {
+    emit jobFinished(jobId, QString());
+    return;
+  }
+
+  // Peak memory of the decoding: the buffer of the decoded image. (32 bits per pixel.)
+  const QSize decodedSize = originalSize.isValid() ? reader.scaledSize() : thumbnail.size();
+
+  // Unknown size: the format doesn't support the scaled decoding.
+  if (!originalSize.isValid())
+    thumbnail = thumbnail.scaled(
+      THUMBNAIL_IMAGE_FILE_WIDTH, THUMBNAIL_IMAGE_FILE_HEIGHT,
+      Qt::KeepAspectRatio, Qt::SmoothTransformation
+    );
+
+  qInfo() << QStringLiteral("Thumbnail of `%1` decoded in %2ms: %3x%4 (%5 bytes) instead of %6x%7 (%8 bytes).")
+    .arg(imagePath).arg(timer.elapsed())
+    .arg(decodedSize.width()).arg(decodedSize.height()).arg(::getDecodeBufferSize(decodedSize))
+    .arg(originalSize.width()).arg(originalSize.height()).arg(::getDecodeBufferSize(originalSize));
+
+  if (isCanceled(jobId))
+    return;
+
+  QByteArray data;
+  {
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!thumbnail.save(&buffer, "jpg", 100)) {
+      qWarning() << QStringLiteral("Unable to encode thumbnail of: `%1`.").arg(imagePath);
+      emit jobFinished(jobId, QString());
+      return;
+    }
+  }
+
+  emit jobFinished(jobId, mThumbnailsCache->insert(data));
+}
+
+// -----------------------------------------------------------------------------
+
+bool ThumbnailGenerator::isCanceled (int jobId) {
+  QMutexLocker locker(&mJobsMutex);
+  return !mJobs.contains(jobId);
+}
+
+void ThumbnailGenerator::handleJobFinished (int jobId, const QString &thumbnailId) {
+  bool canceled;
+  {
+    QMutexLocker locker(&mJobsMutex);
+    canceled = !mJobs.remove(jobId);
+  }
+
+  if (canceled) {
+    if (!thumbnailId.isEmpty())
+      mThumbnailsCache->release(thumbnailId);
+  } else if (thumbnailId.isEmpty())
+    emit thumbnailFailed(jobId);
+  else
+    emit thumbnailCreated(jobId, thumbnailId);
+}
@@ -0,0 +1,80 @@
+/*
+ * ThumbnailGenerator.hpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef THUMBNAIL_GENERATOR_H_
+#define THUMBNAIL_GENERATOR_H_
+
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+
+class ThumbnailsCache;
+
+// =============================================================================
+// Create the thumbnails of file messages in a worker thread.
+// Shared by the chat models, the jobs are bounded for the whole app.
+// =============================================================================
+
+class ThumbnailGenerator : public QObject {
+  Q_OBJECT;
+
+public:
+  ThumbnailGenerator (ThumbnailsCache *thumbnailsCache, QObject *parent = Q_NULLPTR);
+  ~ThumbnailGenerator ();
+
+  // Returns the id of the job, or -1 if the queue is full.
+  int addJob (const QString &imagePath);
+
+  // The thumbnail of a canceled job is released, even if it's already created.
+  void cancelJob (int jobId);
+
+  // Number of created jobs since the start, and jobs which are not yet notified.
+  // A thumbnail reference is not in a message app data while its job is pending.
+  int getJobsCount ();
+  bool hasPendingJobs ();
+
+signals:
+  // Emitted in the thread of the generator. The thumbnail is given with one
+  // reference in the cache.
+  void thumbnailCreated (int jobId, const QString &thumbnailId);
+  void thumbnailFailed (int jobId);
+
+  // Emitted from the worker thread. The thumbnail id is empty on failure.
+  void jobFinished (int jobId, const QString &thumbnailId);
+
+private:
+  void runJob (int jobId, const QString &imagePath);
+
+  bool isCanceled (int jobId);
+
+  void handleJobFinished (int jobId, const QString &thumbnailId);
+
+  ThumbnailsCache *mThumbnailsCache;
+  QThreadPool mThreadPool;
+
+  // Queued or running jobs, and finished jobs which are not yet notified.
+  QMutex mJobsMutex;
+  QSet<int> mJobs;
+  int mLastJobId = 0;
+};
+
+#endif // THUMBNAIL_GENERATOR_H_
@@ -0,0 +1,305 @@
+/*
+ * ThumbnailsCache.cpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#include <algorithm>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSet>
+#include <QTimer>
+
+#include "../../app/paths/Paths.hpp"
+#include "../../utils/StartupProfiler.hpp"
+#include "../../utils/Utils.hpp"
+
+#include "ThumbnailsCache.hpp"
+
+// =============================================================================
+
+using namespace std;
+
+namespace {
+  constexpr char cIndexFileName[] = "index.json";
+  constexpr char cThumbnailExtension[] = ".jpg";
+
+  // In milliseconds. The index changes are coalesced during this delay.
+  constexpr int cSaveDelay = 2000;
+}
+
+ThumbnailsCache::ThumbnailsCache (QObject *parent, qint64 maxSize) : QObject(parent), mMaxSize(maxSize) {
+  mDirPath = ::Utils::coreStringToAppString(Paths::getThumbnailsDirPath());
+  load();
+
+  mSaveTimer = new QTimer(this);
+  mSaveTimer->setSingleShot(true);
+  mSaveTimer->setInterval(cSaveDelay);
+  QObject::connect(mSaveTimer, &QTimer::timeout, this, &ThumbnailsCache::flush);
+}
+
+ThumbnailsCache::~ThumbnailsCache () {
+  flush();
+}
+
+// -----------------------------------------------------------------------------
+
+QString ThumbnailsCache::insert (const QByteArray &data) {
+  const QString id = QString::fromLatin1(
+    QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex()
+  ) + cThumbnailExtension;
+
+  QMutexLocker locker(&mMutex);
+
+  auto it = mEntries.find(id);
+  if (it == mEntries.end() || !QFile::exists(mDirPath + id)) {
+    QSaveFile file(mDirPath + id);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+      qWarning() << QStringLiteral("Unable to write thumbnail: `%1`.").arg(mDirPath + id);
+      return QString();
+    }
+
+    if (it == mEntries.end())
+      it = mEntries.insert(id, Entry());
+    mSize += data.size() - it->size;
+    it->size = data.size();
+  }
+
+  ++it->refs;
+  it->lastAccess = QDateTime::currentMSecsSinceEpoch();
+
+  evict();
+  scheduleSave();
+
+  return id;
+}
+
+void ThumbnailsCache::acquire (const QString &id) {
+  QMutexLocker locker(&mMutex);
+
+  auto it = mEntries.find(id);
+  if (it != mEntries.end()) {
+    ++it->refs;
+    scheduleSave();
+  }
+}
+
+void ThumbnailsCache::release (const QString &id) {
+  QMutexLocker locker(&mMutex);
+
+  auto it = mEntries.find(id);
+  if (it == mEntries.end())
+    return;
+
+  if (--it->refs <= 0)
+    remove(id);
+  scheduleSave();
+}
+
+bool ThumbnailsCache::contains (const QString &id) {
+  QMutexLocker locker(&mMutex);
+  return mEntries.contains(id);
+}
+
+void ThumbnailsCache::touch (const QString &id) {
+  QMutexLocker locker(&mMutex);
+
+  auto it = mEntries.find(id);
+  if (it != mEntries.end())
+    it->lastAccess = QDateTime::currentMSecsSinceEpoch();
+}
+
+// -----------------------------------------------------------------------------
+
+void ThumbnailsCache::sweep () {
+  StartupProfiler::Span span("ThumbnailsCache::sweep");
+
+  // The directory is read without the lock. The candidates are checked again
+  // with the lock before removal: a thumbnail may be inserted meanwhile.
+  QSet<QString> ids;
+  {
+    QMutexLocker locker(&mMutex);
+    for (auto it = mEntries.cbegin(); it != mEntries.cend(); ++it)
+      ids << it.key();
+  }
+
+  QStringList orphanFiles;
+  for (const QFileInfo &info : QDir(mDirPath).entryInfoList(QDir::Files)) {
+    const QString id = info.fileName();
+    if (id != cIndexFileName && !ids.contains(id))
+      orphanFiles << id;
+  }
+
+  QStringList missingFiles;
+  for (const QString &id : ids)
+    if (!QFile::exists(mDirPath + id))
+      missingFiles << id;
+
+  QMutexLocker locker(&mMutex);
+
+  int count = 0;
+
+  // 1. Files which are not in the index.
+  for (const QString &id : orphanFiles)
+    if (!mEntries.contains(id) && QFile::remove(mDirPath + id))
+      ++count;
+
+  // 2. Entries without file.
+  for (const QString &id : missingFiles)
+    if (mEntries.contains(id) && !QFile::exists(mDirPath + id)) {
+      remove(id);
+      ++count;
+    }
+
+  // 3. Unreferenced entries.
+  for (const QString &id : mEntries.keys())
+    if (mEntries[id].refs <= 0) {
+      remove(id);
+      ++count;
+    }
+
+  evict();
+  scheduleSave();
+
+  qInfo() << QStringLiteral("Thumbnails cache swept: %1 orphans removed, %2 thumbnails (%3 bytes).")
+    .arg(count).arg(mEntries.count()).arg(mSize);
+}
+
+void ThumbnailsCache::reconcile (const QHash<QString, int> &refs) {
+  QMutexLocker locker(&mMutex);
+
+  int count = 0;
+  for (const QString &id : mEntries.keys()) {
+    const int entryRefs = refs.value(id, 0);
+    if (entryRefs <= 0) {
+      remove(id);
+      ++count;
+    } else
+      mEntries[id].refs = entryRefs;
+  }
+  scheduleSave();
+
+  qInfo() << QStringLiteral("Thumbnails cache references checked: %1 unreferenced thumbnails removed.").arg(count);
+}
+
+void ThumbnailsCache::flush () {
+  QMutexLocker locker(&mMutex);
+  if (mSaveScheduled) {
+    mSaveScheduled = false;
+    save();
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void ThumbnailsCache::load () {
+  QFile file(mDirPath + cIndexFileName);
+  if (!file.exists()) {
+    // No index: adopt the existing thumbnails. (Created by a previous version.)
+    for (const QFileInfo &info : QDir(mDirPath).entryInfoList(QDir::Files)) {
+      Entry entry;
+      entry.refs = 1;
+      entry.size = info.size();
+      entry.lastAccess = info.lastModified().toMSecsSinceEpoch();
+
+      mEntries[info.fileName()] = entry;
+      mSize += entry.size;
+    }
+    return;
+  }
+
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning() << QStringLiteral("Unable to read thumbnails index: `%1`.").arg(file.fileName());
+    return;
+  }
+
+  const QJsonObject index = QJsonDocument::fromJson(file.readAll()).object();
+  for (auto it = index.constBegin(); it != index.constEnd(); ++it) {
+    const QJsonArray values = it.value().toArray();
+
+    Entry entry;
+    entry.refs = values.at(0).toInt();
+    entry.lastAccess = qint64(values.at(1).toDouble());
+    entry.size = QFileInfo(mDirPath + it.key()).size();
+
+    mEntries[it.key()] = entry;
+    mSize += entry.size;
+  }
+}
+
+void ThumbnailsCache::scheduleSave () {
+  if (mSaveScheduled)
+    return;
+
+  // Can be called from a worker thread.
+  mSaveScheduled = true;
+  QMetaObject::invokeMethod(mSaveTimer, "start", Qt::QueuedConnection);
+}
+
+void ThumbnailsCache::save () {
+  QJsonObject index;
+  for (auto it = mEntries.cbegin(); it != mEntries.cend(); ++it)
+    index[it.key()] = QJsonArray({ it->refs, double(it->lastAccess) });
+
+  QSaveFile file(mDirPath + cIndexFileName);
+  if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(index).toJson(QJsonDocument::Compact)) < 0 || !file.commit())
+    qWarning() << QStringLiteral("Unable to write thumbnails index: `%1`.").arg(file.fileName());
+}
+
+// -----------------------------------------------------------------------------
+
+void ThumbnailsCache::remove (const QString &id) {
+  auto it = mEntries.find(id);
+  if (it == mEntries.end())
+    return;
+
+  mSize -= it->size;
+  mEntries.erase(it);
+
+  const QString path = mDirPath + id;
+  if (QFile::exists(path) && !QFile::remove(path))
+    qWarning() << QStringLiteral("Unable to remove `%1`.").arg(path);
+}
+
+void ThumbnailsCache::evict () {
+  if (mSize <= mMaxSize)
+    return;
+
+  // Least recently used first. The messages of the evicted thumbnails display
+  // the file extension instead.
+  QList<QPair<qint64, QString> > lru;
+  for (auto it = mEntries.cbegin(); it != mEntries.cend(); ++it)
+    lru << qMakePair(it->lastAccess, it.key());
+  sort(lru.begin(), lru.end());
+
+  int count = 0;
+  for (const auto &pair : lru) {
+    if (mSize <= mMaxSize)
+      break;
+    remove(pair.second);
+    ++count;
+  }
+
+  qInfo() << QStringLiteral("Thumbnails cache budget exceeded: %1 thumbnails evicted.").arg(count);
+}
@@ -0,0 +1,90 @@
+/*
+ * ThumbnailsCache.hpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef THUMBNAILS_CACHE_H_
+#define THUMBNAILS_CACHE_H_
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+
+class QTimer;
+
+// =============================================================================
+// On-disk thumbnails, named by content hash and shared between messages.
+// Each message app data holds one reference. Thread-safe.
+// =============================================================================
+
+class ThumbnailsCache : public QObject {
+  Q_OBJECT;
+
+public:
+  ThumbnailsCache (QObject *parent, qint64 maxSize);
+  ~ThumbnailsCache ();
+
+  // Store an encoded thumbnail and returns its id with one reference.
+  // An identical thumbnail is reused. Returns an empty string on failure.
+  QString insert (const QByteArray &data);
+
+  void acquire (const QString &id);
+  void release (const QString &id);
+
+  bool contains (const QString &id);
+
+  // Mark a thumbnail as recently used.
+  void touch (const QString &id);
+
+  // Remove the orphan files and the unreferenced entries, then apply the size budget.
+  void sweep ();
+
+  // Replace the references count of each thumbnail by the number of messages
+  // which use it. Fix the references leaked by a crash.
+  void reconcile (const QHash<QString, int> &refs);
+
+  // Write the index if it was modified. It's written at most once per delay otherwise.
+  void flush ();
+
+private:
+  struct Entry {
+    int refs = 0;
+    qint64 size = 0;
+    qint64 lastAccess = 0;
+  };
+
+  void load ();
+  void save ();
+  void scheduleSave ();
+
+  void remove (const QString &id);
+  void evict ();
+
+  QString mDirPath;
+  qint64 mMaxSize;
+  qint64 mSize = 0;
+
+  QMutex mMutex;
+  QHash<QString, Entry> mEntries;
+
+  bool mSaveScheduled = false;
+  QTimer *mSaveTimer = nullptr;
+};
+
+#endif // THUMBNAILS_CACHE_H_
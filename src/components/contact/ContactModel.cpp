@@ -20,7 +20,10 @@
  *      Author: Ronan Abhamon
  */
 
+#include <QTimer>
+
 #include "../../app/App.hpp"
+#include "../../utils/Utils.hpp"
 
 #include "ContactModel.hpp"
 
@@ -34,7 +37,17 @@ ContactModel::ContactModel (QObject *parent, shared_ptr<linphone::Friend> linpho
   mLinphoneFriend = linphoneFriend;
   mLinphoneFriend->setData("contact-model", *this);
 
-  setVcardModelInternal(new VcardModel(linphoneFriend->getVcard()));
+  // The vcard model is created on demand.
+  QObject::connect(this, &ContactModel::contactUpdated, this, &ContactModel::vcardChanged);
+}
+
+ContactModel::ContactModel (
+  QObject *parent,
+  shared_ptr<linphone::Friend> linphoneFriend,
+  const QVariantList &sipAddresses
+) : ContactModel(parent, linphoneFriend) {
+  mSipAddresses = sipAddresses;
+  mSipAddressesAreValid = true;
 }
 
 ContactModel::ContactModel (QObject *parent, VcardModel *vcardModel) : QObject(parent) {
@@ -47,27 +60,79 @@ ContactModel::ContactModel (QObject *parent, VcardModel *vcardModel) : QObject(p
 
   qInfo() << QStringLiteral("Create contact from vcard:") << this << vcardModel;
   setVcardModelInternal(vcardModel);
+
+  QObject::connect(this, &ContactModel::contactUpdated, this, &ContactModel::vcardChanged);
 }
 
 // -----------------------------------------------------------------------------
 
 void ContactModel::refreshPresence () {
-  Presence::PresenceStatus status = static_cast<Presence::PresenceStatus>(
-      mLinphoneFriend->getConsolidatedPresence()
-    );
-
-  emit presenceStatusChanged(status);
-  emit presenceLevelChanged(Presence::getPresenceLevel(status));
+  // Many notifications can be received in the same event loop iteration.
+  // Only the last presence is signaled.
+  if (mPresenceRefreshPending)
+    return;
+  mPresenceRefreshPending = true;
+
+  QTimer::singleShot(0, this, [this] {
+    mPresenceRefreshPending = false;
+
+    Presence::PresenceStatus status = static_cast<Presence::PresenceStatus>(
+        mLinphoneFriend->getConsolidatedPresence()
+      );
+
+    emit presenceStatusChanged(status);
+    emit presenceLevelChanged(Presence::getPresenceLevel(status));
+  });
 }
 
 // -----------------------------------------------------------------------------
 
 VcardModel *ContactModel::getVcardModel () const {
+  // Most of the contacts are only listed and searched, the vcard model is
+  // created at the first access.
+  if (!mVcardModel) {
+    ContactModel *contact = const_cast<ContactModel *>(this);
+    contact->setVcardModelInternal(new VcardModel(mLinphoneFriend->getVcard()));
+    contact->mVcardModelIsOnDemand = true;
+    emit contact->vcardModelCreated();
+  }
   return mVcardModel;
 }
 
+QString ContactModel::getUsername () const {
+  if (mVcardModel)
+    return mVcardModel->getUsername();
+  return ::Utils::coreStringToAppString(mLinphoneFriend->getVcard()->getFullName());
+}
+
+QVariantList ContactModel::getSipAddresses () const {
+  if (mVcardModel)
+    return mVcardModel->getSipAddresses();
+
+  if (!mSipAddressesAreValid) {
+    mSipAddresses = VcardModel::parseSipAddresses(mLinphoneFriend->getVcard());
+    mSipAddressesAreValid = true;
+  }
+  return mSipAddresses;
+}
+
+bool ContactModel::releaseVcardModel () {
+  if (!mVcardModel || !mVcardModelIsOnDemand)
+    return false;
+
+  // Not modified: the friend vcard is the same.
+  mVcardModel->deleteLater();
+  mVcardModel = nullptr;
+  mVcardModelIsOnDemand = false;
+  mSipAddressesAreValid = false;
+
+  emit vcardChanged();
+
+  return true;
+}
+
 void ContactModel::setVcardModel (VcardModel *vcardModel) {
-  VcardModel *oldVcardModel = mVcardModel;
+  VcardModel *oldVcardModel = getVcardModel();
 
   qInfo() << QStringLiteral("Remove vcard on contact:") << this << oldVcardModel;
   oldVcardModel->mIsReadOnly = false;
@@ -88,6 +153,8 @@ void ContactModel::setVcardModelInternal (VcardModel *vcardModel) {
   Q_ASSERT(vcardModel != mVcardModel);
 
   mVcardModel = vcardModel;
+  mVcardModelIsOnDemand = false;
+  mSipAddressesAreValid = false;
   mVcardModel->mAvatarIsReadOnly = false;
   mVcardModel->mIsReadOnly = true;
 
@@ -143,16 +210,16 @@ void ContactModel::mergeVcardModel (VcardModel *vcardModel) {
 
   // 1. Merge avatar.
   if (vcardModel->getAvatar().isEmpty())
-    vcardModel->setAvatar(mVcardModel->getAvatar());
+    vcardModel->setAvatar(getVcardModel()->getAvatar());
 
   // 2. Merge sip addresses, companies, emails and urls.
-  for (const auto &sipAddress : mVcardModel->getSipAddresses())
+  for (const auto &sipAddress : getVcardModel()->getSipAddresses())
     vcardModel->addSipAddress(sipAddress.toString());
-  for (const auto &company : mVcardModel->getCompanies())
+  for (const auto &company : getVcardModel()->getCompanies())
     vcardModel->addCompany(company.toString());
-  for (const auto &email : mVcardModel->getEmails())
+  for (const auto &email : getVcardModel()->getEmails())
     vcardModel->addEmail(email.toString());
-  for (const auto &url : mVcardModel->getUrls())
+  for (const auto &url : getVcardModel()->getUrls())
     vcardModel->addUrl(url.toString());
 
   // 3. Merge address.
@@ -181,7 +248,7 @@ void ContactModel::mergeVcardModel (VcardModel *vcardModel) {
 // -----------------------------------------------------------------------------
 
 VcardModel *ContactModel::cloneVcardModel () const {
-  shared_ptr<linphone::Vcard> vcard = mVcardModel->mVcard->clone();
+  shared_ptr<linphone::Vcard> vcard = getVcardModel()->mVcard->clone();
   Q_CHECK_PTR(vcard);
   Q_CHECK_PTR(vcard->getVcard());
 
@@ -33,7 +33,7 @@ class ContactModel : public QObject {
 
   Q_PROPERTY(Presence::PresenceStatus presenceStatus READ getPresenceStatus NOTIFY presenceStatusChanged);
   Q_PROPERTY(Presence::PresenceLevel presenceLevel READ getPresenceLevel NOTIFY presenceLevelChanged);
-  Q_PROPERTY(VcardModel * vcard READ getVcardModel WRITE setVcardModel NOTIFY contactUpdated);
+  Q_PROPERTY(VcardModel * vcard READ getVcardModel WRITE setVcardModel NOTIFY vcardChanged);
 
   // Grant access to `mLinphoneFriend`.
   friend class ContactsListModel;
@@ -42,6 +42,8 @@ class ContactModel : public QObject {
 
 public:
   ContactModel (QObject *parent, std::shared_ptr<linphone::Friend> linphoneFriend);
+  // The sip addresses of the friend vcard are already parsed.
+  ContactModel (QObject *parent, std::shared_ptr<linphone::Friend> linphoneFriend, const QVariantList &sipAddresses);
   ContactModel (QObject *parent, VcardModel *vcardModel);
   ~ContactModel () = default;
 
@@ -50,12 +52,24 @@ public:
   VcardModel *getVcardModel () const;
   void setVcardModel (VcardModel *vcardModel);
 
+  // Don't create the vcard model if it doesn't exist.
+  QString getUsername () const;
+  QVariantList getSipAddresses () const;
+
+  // Delete the vcard model if it was created on demand. It is created again
+  // at the next access. Returns true if deleted.
+  bool releaseVcardModel ();
+
   void mergeVcardModel (VcardModel *vcardModel);
 
   Q_INVOKABLE VcardModel *cloneVcardModel () const;
 
 signals:
   void contactUpdated ();
+  void vcardChanged ();
+
+  // Emitted when the vcard model is created on demand.
+  void vcardModelCreated ();
 
   void presenceStatusChanged (Presence::PresenceStatus status);
   void presenceLevelChanged (Presence::PresenceLevel level);
@@ -70,7 +84,15 @@ private:
   Presence::PresenceLevel getPresenceLevel () const;
 
   VcardModel *mVcardModel = nullptr;
+  bool mVcardModelIsOnDemand = false;
   std::shared_ptr<linphone::Friend> mLinphoneFriend;
+
+  // Lightweight record of the vcard, used while the vcard model doesn't exist.
+  // Parsed like `VcardModel::getSipAddresses`.
+  mutable QVariantList mSipAddresses;
+  mutable bool mSipAddressesAreValid = false;
+
+  bool mPresenceRefreshPending = false;
 };
 
 Q_DECLARE_METATYPE(ContactModel *);
@@ -95,6 +95,8 @@ static void removeBelcardPhoto (const shared_ptr<belcard::BelCard> &belcard, boo
 
 // -----------------------------------------------------------------------------
 
+int VcardModel::mSipAddressesCacheHits = 0;
+
 VcardModel::VcardModel (shared_ptr<linphone::Vcard> vcard, bool isReadOnly) {
   Q_CHECK_PTR(vcard);
   mVcard = vcard;
@@ -267,12 +269,23 @@ void VcardModel::setCountry (const QString &country) {
 // -----------------------------------------------------------------------------
 
 QVariantList VcardModel::getSipAddresses () const {
-  shared_ptr<linphone::Core> core = CoreManager::getInstance()->getCore();
+  if (mSipAddressesAreValid) {
+    ++mSipAddressesCacheHits;
+    return mSipAddresses;
+  }
+
+  mSipAddresses = parseSipAddresses(mVcard);
+  mSipAddressesAreValid = true;
+
+  return mSipAddresses;
+}
+
+QVariantList VcardModel::parseSipAddresses (const shared_ptr<linphone::Vcard> &vcard) {
   QVariantList list;
 
-  for (const auto &address : mVcard->getVcard()->getImpp()) {
+  for (const auto &address : vcard->getVcard()->getImpp()) {
     string value = address->getValue();
-    shared_ptr<linphone::Address> linphoneAddress = core->createAddress(value);
+    shared_ptr<linphone::Address> linphoneAddress = linphone::Factory::get()->createAddress(value);
 
     if (linphoneAddress)
       list << ::Utils::coreStringToAppString(linphoneAddress->asStringUriOnly());
@@ -305,6 +318,7 @@ bool VcardModel::addSipAddress (const QString &sipAddress) {
   }
 
   qInfo() << QStringLiteral("Add new sip address on vcard: `%1`.").arg(sipAddress);
+  mSipAddressesAreValid = false;
 
   emit vcardUpdated();
   return true;
@@ -332,6 +346,7 @@ void VcardModel::removeSipAddress (const QString &sipAddress) {
 
   qInfo() << QStringLiteral("Remove sip address on vcard: `%1`.").arg(sipAddress);
   belcard->removeImpp(value);
+  mSipAddressesAreValid = false;
 
   emit vcardUpdated();
 }
@@ -342,6 +357,10 @@ bool VcardModel::updateSipAddress (const QString &oldSipAddress, const QString &
   return soFarSoGood;
 }
 
+int VcardModel::getSipAddressesCacheHits () {
+  return mSipAddressesCacheHits;
+}
+
 // -----------------------------------------------------------------------------
 
 QVariantList VcardModel::getCompanies () const {
@@ -95,6 +95,15 @@ public:
 
   // ---------------------------------------------------------------------------
 
+  // Number of `getSipAddresses` calls served without parsing the vcard.
+  static int getSipAddressesCacheHits ();
+
+  // Sip addresses of a vcard, also used by the contacts without vcard model.
+  // Doesn't use the core, so it can be called in a worker thread.
+  static QVariantList parseSipAddresses (const std::shared_ptr<linphone::Vcard> &vcard);
+
+  // ---------------------------------------------------------------------------
+
 signals:
   void vcardUpdated ();
 
@@ -105,6 +114,12 @@ private:
   bool mAvatarIsReadOnly = true;
 
   std::shared_ptr<linphone::Vcard> mVcard;
+
+  // Parsed sip addresses. Invalidated when a sip address is added or removed.
+  mutable QVariantList mSipAddresses;
+  mutable bool mSipAddressesAreValid = false;
+
+  static int mSipAddressesCacheHits;
 };
 
 Q_DECLARE_METATYPE(VcardModel *);
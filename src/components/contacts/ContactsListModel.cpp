@@ -20,36 +20,127 @@
  *      Author: Ronan Abhamon
  */
 
+#include <belcard/belcard.hpp>
+#include <belcard/belcard_parser.hpp>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <QTimer>
+
 #include "../../app/App.hpp"
+#include "../../utils/Utils.hpp"
 #include "../core/CoreManager.hpp"
 
 #include "ContactsListModel.hpp"
 
 using namespace std;
 
+namespace {
+  // Max number of vcard models created on demand. Above, the oldest are released.
+  constexpr int cMaxOnDemandVcardModels = 200;
+}
+
 // =============================================================================
 
-ContactsListModel::ContactsListModel (QObject *parent) : QAbstractListModel(parent) {
-  mLinphoneFriends = CoreManager::getInstance()->getCore()->getFriendsLists().front();
+// Returns the vcards of a file, one string per `BEGIN:VCARD`/`END:VCARD` block.
+static QList<string> splitVcards (const QByteArray &data) {
+  static const QByteArray begin("BEGIN:VCARD");
+  static const QByteArray end("END:VCARD");
+
+  const QByteArray upperData = data.toUpper();
+  QList<string> vcards;
+
+  for (int index = 0; (index = upperData.indexOf(begin, index)) != -1;) {
+    int last = upperData.indexOf(end, index);
+    if (last == -1)
+      break;
+
+    last += end.length();
+    vcards << data.mid(index, last - index).append("\r\n").toStdString();
+    index = last;
+  }
+
+  return vcards;
+}
+
+// Can be called in any thread, the core is not used.
+static shared_ptr<linphone::Vcard> parseVcard (const string &data) {
+  belcard::BelCardParser parser;
+  shared_ptr<belcard::BelCard> belcard = parser.parseOne(data);
+  if (!belcard || !belcard->getFullName())
+    return nullptr;
+
+  shared_ptr<linphone::Vcard> vcard = linphone::Factory::get()->createVcard();
+  vcard->setFullName(belcard->getFullName()->getValue());
+
+  // Only the properties supported by `VcardModel` are imported.
+  shared_ptr<belcard::BelCard> dest = vcard->getVcard();
+  for (const auto &value : belcard->getImpp())
+    dest->addImpp(value);
+  for (const auto &value : belcard->getRoles())
+    dest->addRole(value);
+  for (const auto &value : belcard->getEmails())
+    dest->addEmail(value);
+  for (const auto &value : belcard->getURLs())
+    dest->addURL(value);
+  for (const auto &value : belcard->getAddresses())
+    dest->addAddress(value);
+
+  return vcard;
+}
+
+// -----------------------------------------------------------------------------
+
+QList<ContactsListModel::FriendData> ContactsListModel::readFriends () {
+  shared_ptr<linphone::FriendList> linphoneFriends = CoreManager::getInstance()->getCore()->getFriendsLists().front();
+  QList<FriendData> friends;
 
   // Clean friends.
-  {
-    list<shared_ptr<linphone::Friend> > toRemove;
-    for (const auto &linphoneFriend : mLinphoneFriends->getFriends()) {
-      if (!linphoneFriend->getVcard())
-        toRemove.push_back(linphoneFriend);
-    }
+  list<shared_ptr<linphone::Friend> > toRemove;
+  for (const auto &linphoneFriend : linphoneFriends->getFriends()) {
+    shared_ptr<linphone::Vcard> vcard = linphoneFriend->getVcard();
+    if (vcard)
+      friends << FriendData{ linphoneFriend, vcard, QVariantList() };
+    else
+      toRemove.push_back(linphoneFriend);
+  }
 
-    for (const auto &linphoneFriend : toRemove) {
-      qWarning() << QStringLiteral("Remove one linphone friend without vcard.");
-      mLinphoneFriends->removeFriend(linphoneFriend);
-    }
+  for (const auto &linphoneFriend : toRemove) {
+    qWarning() << QStringLiteral("Remove one linphone friend without vcard.");
+    linphoneFriends->removeFriend(linphoneFriend);
   }
 
-  // Init contacts with linphone friends list.
+  return friends;
+}
+
+void ContactsListModel::parseFriends (QList<FriendData> *friends) {
+  QElapsedTimer timer;
+  timer.start();
+
+  for (auto &data : *friends)
+    data.sipAddresses = VcardModel::parseSipAddresses(data.vcard);
+
+  qInfo() << QStringLiteral("Parse %1 friends in %2ms.").arg(friends->count()).arg(timer.elapsed());
+}
+
+// -----------------------------------------------------------------------------
+
+ContactsListModel::ContactsListModel (QObject *parent, const QList<FriendData> &friends) : QAbstractListModel(parent) {
+  // Released at the next event loop iteration, not while a view reads a vcard.
+  mVcardModelsTimer = new QTimer(this);
+  mVcardModelsTimer->setSingleShot(true);
+  mVcardModelsTimer->setInterval(0);
+  QObject::connect(mVcardModelsTimer, &QTimer::timeout, this, &ContactsListModel::releaseVcardModels);
+
+  mLinphoneFriends = CoreManager::getInstance()->getCore()->getFriendsLists().front();
+
+  // Init contacts with the friends read by `readFriends`.
+  // The vcard models are not created here, only the friends data are used.
+  QElapsedTimer timer;
+  timer.start();
+
   QQmlEngine *engine = App::getInstance()->getEngine();
-  for (const auto &linphoneFriend : mLinphoneFriends->getFriends()) {
-    ContactModel *contact = new ContactModel(this, linphoneFriend);
+  for (const auto &data : friends) {
+    ContactModel *contact = new ContactModel(this, data.linphoneFriend, data.sipAddresses);
 
     // See: http://doc.qt.io/qt-5/qtqml-cppintegration-data.html#data-ownership
     // The returned value must have a explicit parent or a QQmlEngine::CppOwnership.
@@ -57,6 +148,8 @@ ContactsListModel::ContactsListModel (QObject *parent) : QAbstractListModel(pare
 
     addContact(contact);
   }
+
+  qInfo() << QStringLiteral("Init %1 contacts in %2ms.").arg(mList.count()).arg(timer.elapsed());
 }
 
 int ContactsListModel::rowCount (const QModelIndex &) const {
@@ -97,6 +190,9 @@ bool ContactsListModel::removeRows (int row, int count, const QModelIndex &paren
     ContactModel *contact = mList.takeAt(row);
 
     mLinphoneFriends->removeFriend(contact->mLinphoneFriend);
+    mSearchIndex.remove(getSearchKey(contact));
+    unindexContact(contact);
+    mOnDemandVcardContacts.removeOne(contact);
 
     emit contactRemoved(contact);
     contact->deleteLater();
@@ -110,19 +206,13 @@ bool ContactsListModel::removeRows (int row, int count, const QModelIndex &paren
 // -----------------------------------------------------------------------------
 
 ContactModel *ContactsListModel::findContactModelFromSipAddress (const QString &sipAddress) const {
-  auto it = find_if(mList.begin(), mList.end(), [&sipAddress](ContactModel *contactModel) {
-        return contactModel->getVcardModel()->getSipAddresses().contains(sipAddress);
-      });
-
-  return it != mList.end() ? *it : nullptr;
+  auto it = mContactsBySipAddress.find(sipAddress);
+  return it == mContactsBySipAddress.end() ? nullptr : it->first();
 }
 
 ContactModel *ContactsListModel::findContactModelFromUsername (const QString &username) const {
-  auto it = find_if(mList.begin(), mList.end(), [&username](ContactModel *contactModel) {
-        return contactModel->getVcardModel()->getUsername() == username;
-      });
-
-  return it != mList.end() ? *it : nullptr;
+  auto it = mContactsByUsername.find(username);
+  return it == mContactsByUsername.end() ? nullptr : it->first();
 }
 
 // -----------------------------------------------------------------------------
@@ -163,6 +253,87 @@ ContactModel *ContactsListModel::addContact (VcardModel *vcardModel) {
   return contact;
 }
 
+QList<ContactModel *> ContactsListModel::addContacts (const QList<VcardModel *> &vcardModels) {
+  QQmlEngine *engine = App::getInstance()->getEngine();
+
+  QList<ContactModel *> contacts;
+  QHash<QString, ContactModel *> contactsByUsername;
+
+  for (VcardModel *vcardModel : vcardModels) {
+    const QString username = vcardModel->getUsername();
+
+    // Try to merge vcardModel to an existing or a new contact.
+    ContactModel *contact = findContactModelFromUsername(username);
+    if (!contact)
+      contact = contactsByUsername.value(username, nullptr);
+    if (contact) {
+      contact->mergeVcardModel(vcardModel);
+      continue;
+    }
+
+    contact = new ContactModel(this, vcardModel);
+    engine->setObjectOwnership(contact, QQmlEngine::CppOwnership);
+
+    if (
+      mLinphoneFriends->addFriend(contact->mLinphoneFriend) !=
+      linphone::FriendListStatus::FriendListStatusOK
+    ) {
+      qWarning() << QStringLiteral("Unable to add contact from vcard:") << vcardModel;
+      delete contact;
+      continue;
+    }
+
+    contacts << contact;
+    contactsByUsername.insert(username, contact);
+  }
+
+  qInfo() << QStringLiteral("Add %1 contacts from %2 vcards.").arg(contacts.count()).arg(vcardModels.count());
+
+  if (contacts.isEmpty())
+    return contacts;
+
+  // Make sure new subscribe is issued.
+  mLinphoneFriends->updateSubscriptions();
+
+  int row = mList.count();
+
+  beginInsertRows(QModelIndex(), row, row + contacts.count() - 1);
+  for (ContactModel *contact : contacts)
+    addContact(contact);
+  endInsertRows();
+
+  emit contactsAdded(contacts);
+
+  return contacts;
+}
+
+void ContactsListModel::importContacts (const QString &path) {
+  if (mImportWatcher) {
+    qWarning() << QStringLiteral("Unable to import `%1`, an import is already running.").arg(path);
+    return;
+  }
+
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning() << QStringLiteral("Unable to open vcards file: `%1`.").arg(path);
+    emit contactsImported(0);
+    return;
+  }
+
+  const QList<string> vcards = ::splitVcards(file.readAll());
+  const int total = vcards.count();
+
+  qInfo() << QStringLiteral("Import %1 vcards from `%2`.").arg(total).arg(path);
+
+  mImportWatcher = new QFutureWatcher<shared_ptr<linphone::Vcard> >(this);
+  QObject::connect(mImportWatcher, &QFutureWatcherBase::progressValueChanged, this, [this, total](int count) {
+    emit importProgress(count, total);
+  });
+  QObject::connect(mImportWatcher, &QFutureWatcherBase::finished, this, &ContactsListModel::handleImportFinished);
+
+  mImportWatcher->setFuture(QtConcurrent::mapped(vcards, ::parseVcard));
+}
+
 void ContactsListModel::removeContact (ContactModel *contact) {
   qInfo() << QStringLiteral("Removing contact:") << contact;
 
@@ -185,16 +356,125 @@ void ContactsListModel::cleanAvatars () {
 
 // -----------------------------------------------------------------------------
 
+void ContactsListModel::handleImportFinished () {
+  QList<VcardModel *> vcardModels;
+  for (const auto &vcard : mImportWatcher->future().results())
+    if (vcard)
+      vcardModels << new VcardModel(vcard, false);
+
+  const int invalidCount = mImportWatcher->future().resultCount() - vcardModels.count();
+  if (invalidCount)
+    qWarning() << QStringLiteral("Unable to parse %1 vcards.").arg(invalidCount);
+
+  mImportWatcher->deleteLater();
+  mImportWatcher = nullptr;
+
+  emit contactsImported(addContacts(vcardModels).count());
+}
+
 void ContactsListModel::addContact (ContactModel *contact) {
   QObject::connect(contact, &ContactModel::contactUpdated, this, [this, contact]() {
+      indexUsername(contact);
+      updateSearchIndex(contact);
       emit contactUpdated(contact);
     });
   QObject::connect(contact, &ContactModel::sipAddressAdded, this, [this, contact](const QString &sipAddress) {
+      indexSipAddress(contact, sipAddress);
+      updateSearchIndex(contact);
       emit sipAddressAdded(contact, sipAddress);
     });
   QObject::connect(contact, &ContactModel::sipAddressRemoved, this, [this, contact](const QString &sipAddress) {
+      unindexSipAddress(contact, sipAddress);
+      updateSearchIndex(contact);
       emit sipAddressRemoved(contact, sipAddress);
     });
+  QObject::connect(contact, &ContactModel::vcardModelCreated, this, [this, contact]() {
+      mOnDemandVcardContacts << contact;
+      if (mOnDemandVcardContacts.count() > cMaxOnDemandVcardModels)
+        mVcardModelsTimer->start();
+    });
 
   mList << contact;
+  indexContact(contact);
+  updateSearchIndex(contact);
+}
+
+// -----------------------------------------------------------------------------
+
+void ContactsListModel::releaseVcardModels () {
+  // The oldest created first. A vcard model replaced since is not released.
+  int count = 0;
+  while (mOnDemandVcardContacts.count() > cMaxOnDemandVcardModels)
+    count += mOnDemandVcardContacts.takeFirst()->releaseVcardModel();
+
+  qInfo() << QStringLiteral("Release %1 vcard models.").arg(count);
+}
+
+// -----------------------------------------------------------------------------
+
+QString ContactsListModel::getSearchKey (const ContactModel *contact) {
+  return QString::number(quintptr(contact), 16);
+}
+
+void ContactsListModel::updateSearchIndex (const ContactModel *contact) {
+  // Username first, then the sip addresses without the `sip:` scheme, like `SipAddressesModel`.
+  QStringList fields(contact->getUsername());
+  for (const auto &sipAddress : contact->getSipAddresses())
+    fields << sipAddress.toString().mid(4);
+
+  mSearchIndex.insert(getSearchKey(contact), fields);
+}
+
+// -----------------------------------------------------------------------------
+
+void ContactsListModel::indexContact (ContactModel *contact) {
+  for (const auto &sipAddress : contact->getSipAddresses())
+    indexSipAddress(contact, sipAddress.toString());
+  indexUsername(contact);
+}
+
+void ContactsListModel::unindexContact (ContactModel *contact) {
+  for (const auto &sipAddress : contact->getSipAddresses())
+    unindexSipAddress(contact, sipAddress.toString());
+  unindexUsername(contact);
+}
+
+void ContactsListModel::indexSipAddress (ContactModel *contact, const QString &sipAddress) {
+  QList<ContactModel *> &contacts = mContactsBySipAddress[sipAddress];
+  if (!contacts.contains(contact))
+    contacts << contact;
+}
+
+void ContactsListModel::unindexSipAddress (ContactModel *contact, const QString &sipAddress) {
+  auto it = mContactsBySipAddress.find(sipAddress);
+  if (it == mContactsBySipAddress.end())
+    return;
+
+  it->removeOne(contact);
+  if (it->isEmpty())
+    mContactsBySipAddress.erase(it);
+}
+
+void ContactsListModel::indexUsername (ContactModel *contact) {
+  const QString username = contact->getUsername();
+
+  auto it = mUsernames.find(contact);
+  if (it != mUsernames.end()) {
+    if (*it == username)
+      return;
+    unindexUsername(contact);
+  }
+
+  mUsernames.insert(contact, username);
+  mContactsByUsername[username] << contact;
+}
+
+void ContactsListModel::unindexUsername (ContactModel *contact) {
+  auto it = mContactsByUsername.find(mUsernames.take(contact));
+  if (it == mContactsByUsername.end())
+    return;
+
+  it->removeOne(contact);
+  if (it->isEmpty())
+    mContactsByUsername.erase(it);
 }
@@ -25,18 +25,36 @@
 
 #include <linphone++/linphone.hh>
 #include <QAbstractListModel>
+#include <QFutureWatcher>
 
 #include "../contact/ContactModel.hpp"
+#include "../search/SearchIndex.hpp"
 
 // =============================================================================
 
+class QTimer;
+
 class ContactsListModel : public QAbstractListModel {
   friend class SipAddressesModel;
 
   Q_OBJECT;
 
 public:
-  ContactsListModel (QObject *parent = Q_NULLPTR);
+  // A friend of the core and the sip addresses of its vcard.
+  struct FriendData {
+    std::shared_ptr<linphone::Friend> linphoneFriend;
+    std::shared_ptr<linphone::Vcard> vcard;
+    QVariantList sipAddresses;
+  };
+
+  // Read the friends with a vcard, the others are removed. Uses the core.
+  static QList<FriendData> readFriends ();
+
+  // Parse the sip addresses of the friends. Doesn't use the core, so it can be
+  // called in a worker thread while the list is not used elsewhere.
+  static void parseFriends (QList<FriendData> *friends);
+
+  ContactsListModel (QObject *parent, const QList<FriendData> &friends);
   ~ContactsListModel () = default;
 
   int rowCount (const QModelIndex &index = QModelIndex()) const override;
@@ -53,20 +71,66 @@ public:
   Q_INVOKABLE ContactModel *addContact (VcardModel *vcardModel);
   Q_INVOKABLE void removeContact (ContactModel *contact);
 
+  // Add many contacts with one rows insertion and one subscriptions update.
+  // The vcards with the same username are merged. Returns the new contacts.
+  QList<ContactModel *> addContacts (const QList<VcardModel *> &vcardModels);
+
+  // Import a vcard file. The vcards are parsed in a threads pool.
+  Q_INVOKABLE void importContacts (const QString &path);
+
   Q_INVOKABLE void cleanAvatars ();
 
+  // Usernames and sip addresses of the contacts.
+  const SearchIndex *getSearchIndex () const {
+    return &mSearchIndex;
+  }
+
+  static QString getSearchKey (const ContactModel *contact);
+
 signals:
   void contactAdded (ContactModel *contact);
   void contactRemoved (const ContactModel *contact);
   void contactUpdated (ContactModel *contact);
 
+  void contactsAdded (const QList<ContactModel *> &contacts);
+
+  void importProgress (int count, int total);
+  void contactsImported (int count);
+
   void sipAddressAdded (ContactModel *contact, const QString &sipAddress);
   void sipAddressRemoved (ContactModel *contact, const QString &sipAddress);
 
 private:
   void addContact (ContactModel *contact);
 
+  void handleImportFinished ();
+
+  void updateSearchIndex (const ContactModel *contact);
+
+  void releaseVcardModels ();
+
+  void indexContact (ContactModel *contact);
+  void unindexContact (ContactModel *contact);
+
+  void indexSipAddress (ContactModel *contact, const QString &sipAddress);
+  void unindexSipAddress (ContactModel *contact, const QString &sipAddress);
+
+  void indexUsername (ContactModel *contact);
+  void unindexUsername (ContactModel *contact);
+
   QList<ContactModel *> mList;
+  SearchIndex mSearchIndex;
+
+  // Lookup tables. If several contacts use the same key, the first added is found.
+  QHash<QString, QList<ContactModel *> > mContactsBySipAddress;
+  QHash<QString, QList<ContactModel *> > mContactsByUsername;
+  QHash<ContactModel *, QString> mUsernames;
+
+  // Contacts with a vcard model created on demand, from the oldest.
+  QList<ContactModel *> mOnDemandVcardContacts;
+  QTimer *mVcardModelsTimer = nullptr;
+
+  QFutureWatcher<std::shared_ptr<linphone::Vcard> > *mImportWatcher = nullptr;
   std::shared_ptr<linphone::FriendList> mLinphoneFriends;
 };
 
@@ -22,7 +22,6 @@
 
 #include <cmath>
 
-#include "../../utils/Utils.hpp"
 #include "../core/CoreManager.hpp"
 
 #include "ContactsListProxyModel.hpp"
@@ -40,27 +39,53 @@ using namespace std;
 
 // =============================================================================
 
-// Notes:
-//
-// - First `^` is necessary to search two words with one separator
-// between them like `Claire Manning`.
-//
-// - [^_.-;@ ] is used to search patterns which starts with
-// a separator like ` word`.
-//
-// - [_.-;@ ] is the main pattern (a separator).
-const QRegExp ContactsListProxyModel::mSearchSeparators("^[^_.-;@ ][_.-;@ ]");
+ContactsListProxyModel::ContactsListProxyModel (QObject *parent) : QSortFilterProxyModel(parent) {
+  ContactsListModel *contacts = CoreManager::getInstance()->getContactsListModel();
+  mSearchIndex = contacts->getSearchIndex();
+
+  // Must be connected before `setSourceModel` to be handled before the proxy updates.
+  QObject::connect(contacts, &ContactsListModel::rowsInserted, this, [this, contacts](const QModelIndex &, int first, int last) {
+    for (int row = first; row <= last; ++row)
+      updateWeight(contacts->index(row, 0).data().value<ContactModel *>());
+  });
+  QObject::connect(contacts, &ContactsListModel::contactUpdated, this, [this](ContactModel *contact) {
+    updateWeight(contact);
+    invalidate();
+  });
 
-// -----------------------------------------------------------------------------
+  setFilter(QString());
 
-ContactsListProxyModel::ContactsListProxyModel (QObject *parent) : QSortFilterProxyModel(parent) {
-  setSourceModel(CoreManager::getInstance()->getContactsListModel());
+  setSourceModel(contacts);
   sort(0);
 }
 
 // -----------------------------------------------------------------------------
 
 void ContactsListProxyModel::setFilter (const QString &pattern) {
+  // A refined filter can't match a contact rejected by the previous one.
+  if (!mFilter.isEmpty() && pattern.contains(mFilter, Qt::CaseInsensitive)) {
+    for (auto it = mWeights.begin(); it != mWeights.end(); ) {
+      const SearchIndex::Match match = mSearchIndex->match(it.key(), pattern);
+      unsigned int weight = match.isEmpty() ? 0 : computeWeight(match);
+      if (weight == 0)
+        it = mWeights.erase(it);
+      else {
+        *it = weight;
+        ++it;
+      }
+    }
+  } else {
+    const QHash<QString, SearchIndex::Match> matches = mSearchIndex->search(pattern);
+
+    mWeights.clear();
+    mWeights.reserve(matches.count());
+    for (auto it = matches.cbegin(); it != matches.cend(); ++it) {
+      unsigned int weight = computeWeight(*it);
+      if (weight > 0)
+        mWeights.insert(it.key(), weight);
+    }
+  }
+
   mFilter = pattern;
   invalidate();
 }
@@ -74,9 +99,7 @@ bool ContactsListProxyModel::filterAcceptsRow (
   const QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
   const ContactModel *contact = index.data().value<ContactModel *>();
 
-  mWeights[contact] = uint(round(computeContactWeight(contact)));
-
-  return mWeights[contact] > 0 && (
+  return getWeight(contact) > 0 && (
     !mUseConnectedFilter ||
     contact->getPresenceLevel() != Presence::PresenceLevel::White
   );
@@ -86,8 +109,8 @@ bool ContactsListProxyModel::lessThan (const QModelIndex &left, const QModelInde
   const ContactModel *contactA = sourceModel()->data(left).value<ContactModel *>();
   const ContactModel *contactB = sourceModel()->data(right).value<ContactModel *>();
 
-  unsigned int weightA = mWeights[contactA];
-  unsigned int weightB = mWeights[contactB];
+  unsigned int weightA = getWeight(contactA);
+  unsigned int weightB = getWeight(contactB);
 
   // Sort by weight and name.
   return weightA > weightB || (
@@ -98,19 +121,22 @@ bool ContactsListProxyModel::lessThan (const QModelIndex &left, const QModelInde
 
 // -----------------------------------------------------------------------------
 
-float ContactsListProxyModel::computeStringWeight (const QString &string, float percentage) const {
-  int index = -1;
-  int offset = -1;
+void ContactsListProxyModel::updateWeight (const ContactModel *contact) {
+  const QString key = ContactsListModel::getSearchKey(contact);
+  const SearchIndex::Match match = mSearchIndex->match(key, mFilter);
 
-  // Search pattern.
-  while ((index = string.indexOf(mFilter, index + 1, Qt::CaseInsensitive)) != -1) {
-    // Search n chars between one separator and index.
-    int tmpOffset = index - string.lastIndexOf(mSearchSeparators, index) - 1;
+  unsigned int weight = match.isEmpty() ? 0 : computeWeight(match);
+  if (weight == 0)
+    mWeights.remove(key);
+  else
+    mWeights[key] = weight;
+}
 
-    if ((tmpOffset != -1 && tmpOffset < offset) || offset == -1)
-      if ((offset = tmpOffset) == 0) break;
-  }
+unsigned int ContactsListProxyModel::getWeight (const ContactModel *contact) const {
+  return mWeights.value(ContactsListModel::getSearchKey(contact), 0);
+}
 
+static inline float computeFieldWeight (int offset, float percentage) {
   switch (offset) {
     case -1: return 0;
     case 0: return percentage * FACTOR_POS_0;
@@ -123,20 +149,15 @@ float ContactsListProxyModel::computeStringWeight (const QString &string, float
   return percentage * FACTOR_POS_OTHER;
 }
 
-float ContactsListProxyModel::computeContactWeight (const ContactModel *contact) const {
-  float weight = computeStringWeight(contact->getVcardModel()->getUsername(), USERNAME_WEIGHT);
-
-  // Get all contact's addresses.
-  const list<shared_ptr<linphone::Address> > addresses = contact->mLinphoneFriend->getAddresses();
+unsigned int ContactsListProxyModel::computeWeight (const SearchIndex::Match &match) {
+  // The first field is the username, the others are the sip addresses.
+  float weight = computeFieldWeight(match[0], USERNAME_WEIGHT);
 
-  float size = float(addresses.size());
-  for (auto it = addresses.cbegin(); it != addresses.cend(); ++it)
-    weight += computeStringWeight(
-        ::Utils::coreStringToAppString((*it)->asStringUriOnly()),
-        SIP_ADDRESSES_WEIGHT / size
-      );
+  float size = float(match.count() - 1);
+  for (int i = 1; i < match.count(); ++i)
+    weight += computeFieldWeight(match[i], SIP_ADDRESSES_WEIGHT / size);
 
-  return weight;
+  return uint(round(weight));
 }
 
 // -----------------------------------------------------------------------------
@@ -25,6 +25,8 @@
 
 #include <QSortFilterProxyModel>
 
+#include "../search/SearchIndex.hpp"
+
 // =============================================================================
 
 class ContactModel;
@@ -50,8 +52,11 @@ protected:
   bool lessThan (const QModelIndex &left, const QModelIndex &right) const override;
 
 private:
-  float computeStringWeight (const QString &string, float percentage) const;
-  float computeContactWeight (const ContactModel *contact) const;
+  void updateWeight (const ContactModel *contact);
+
+  unsigned int getWeight (const ContactModel *contact) const;
+
+  static unsigned int computeWeight (const SearchIndex::Match &match);
 
   bool isConnectedFilterUsed () const {
     return mUseConnectedFilter;
@@ -62,11 +67,11 @@ private:
   QString mFilter;
   bool mUseConnectedFilter = false;
 
-  // It's just a cache to save values computed by `filterAcceptsRow`
-  // and reused by `lessThan`.
-  mutable QHash<const ContactModel *, unsigned int> mWeights;
+  // Search key => weight for the current filter. Only the matching contacts
+  // are stored. If the filter is refined, only these ones are checked again.
+  QHash<QString, unsigned int> mWeights;
 
-  static const QRegExp mSearchSeparators;
+  const SearchIndex *mSearchIndex = nullptr;
 };
 
 #endif // CONTACTS_LIST_PROXY_MODEL_H_
@@ -100,6 +100,7 @@ void CoreHandlers::onCallStateChanged (
   linphone::CallState state,
   const string &
 ) {
+  CoreManager::getInstance()->markCoreCallback();
   emit callStateChanged(call, state);
 
   if (call->getState() == linphone::CallStateIncomingReceived)
@@ -134,6 +135,7 @@ void CoreHandlers::onIsComposingReceived (
   const shared_ptr<linphone::Core> &,
   const shared_ptr<linphone::ChatRoom> &room
 ) {
+  CoreManager::getInstance()->markCoreCallback();
   emit isComposingChanged(room);
 }
 
@@ -161,6 +163,7 @@ void CoreHandlers::onMessageReceived (
   const string contentType = message->getContentType();
 
   if (contentType == "text/plain" || contentType == "application/vnd.gsma.rcs-ft-http+xml") {
+    CoreManager::getInstance()->markCoreCallback();
     emit messageReceived(message);
 
     const App *app = App::getInstance();
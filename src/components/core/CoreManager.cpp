@@ -21,11 +21,13 @@
  */
 
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QDir>
 #include <QtConcurrent>
 #include <QTimer>
 
 #include "../../app/paths/Paths.hpp"
+#include "../../utils/StartupProfiler.hpp"
 #include "../../utils/Utils.hpp"
 
 #if defined(Q_OS_LINUX)
@@ -45,6 +47,13 @@ using namespace std;
 namespace {
   constexpr int cCbsCallInterval = 20;
 
+  // In milliseconds.
+  constexpr int cDefaultIdleIterateInterval = 100;
+  constexpr qint64 cCoreActivityDuration = 2000;
+
+  // In milliseconds.
+  constexpr qint64 cIterateStatsLogInterval = 10 * 60 * 1000;
+
   constexpr char cRcVersionName[] = "rc_version";
   constexpr int cRcVersionCurrent = 1;
 
@@ -52,6 +61,17 @@ namespace {
   constexpr char cLinphoneDomain[] = "sip.linphone.org";
   constexpr char cDefaultContactParameters[] = "message-expires=604800";
   constexpr int cDefaultExpires = 3600;
+
+  // In bytes.
+  constexpr int cDefaultThumbnailsCacheMaxSize = 50 * 1024 * 1024;
+
+  // The references of the thumbnails are checked once per interval (in seconds),
+  // a while (in milliseconds) after the start.
+  constexpr char cThumbnailsLastCheckName[] = "thumbnails_cache_last_check";
+  constexpr qint64 cThumbnailsCheckInterval = 7 * 24 * 60 * 60;
+  constexpr int cThumbnailsCheckDelay = 60 * 1000;
+  constexpr int cThumbnailsCheckPageSize = 100;
+
   constexpr char cDownloadUrl[] = "https://www.linphone.org/technical-corner/linphone/downloads";
 }
 
@@ -62,6 +82,7 @@ CoreManager *CoreManager::mInstance = nullptr;
 CoreManager::CoreManager (QObject *parent, const QString &configPath) :
   QObject(parent), mHandlers(make_shared<CoreHandlers>(this)) {
   mPromiseBuild = QtConcurrent::run(this, &CoreManager::createLinphoneCore, configPath);
+  mPromiseSnapshot = QtConcurrent::run(&SipAddressesModel::readSnapshot);
 
   QObject::connect(&mPromiseWatcher, &QFutureWatcher<void>::finished, this, [] {
     qInfo() << QStringLiteral("Core created. Enable iterate.");
@@ -73,23 +94,81 @@ CoreManager::CoreManager (QObject *parent, const QString &configPath) :
   CoreHandlers *coreHandlers = mHandlers.get();
 
   QObject::connect(coreHandlers, &CoreHandlers::coreStarted, this, [] {
+    StartupProfiler::Span span("CoreManager::coreStarted");
+
     {
       MessagesCountNotifier *messagesCountNotifier = new MessagesCountNotifier(mInstance);
       messagesCountNotifier->updateUnreadMessagesCount();
     }
 
-    mInstance->mCallsListModel = new CallsListModel(mInstance);
-    mInstance->mContactsListModel = new ContactsListModel(mInstance);
-    mInstance->mSipAddressesModel = new SipAddressesModel(mInstance);
-    mInstance->mSettingsModel = new SettingsModel(mInstance);
-    mInstance->mAccountSettingsModel = new AccountSettingsModel(mInstance);
+    mInstance->mThumbnailsCache = new ThumbnailsCache(mInstance, mInstance->mCore->getConfig()->getInt(
+      SettingsModel::UI_SECTION, "thumbnails_cache_max_size", cDefaultThumbnailsCacheMaxSize
+    ));
+    mInstance->mPromiseSweep = QtConcurrent::run(mInstance->mThumbnailsCache, &ThumbnailsCache::sweep);
+    mInstance->mThumbnailGenerator = new ThumbnailGenerator(mInstance->mThumbnailsCache, mInstance);
+
+    mInstance->mIdleIterateInterval = qMax(mInstance->mCore->getConfig()->getInt(
+      SettingsModel::UI_SECTION, "idle_iterate_interval", cDefaultIdleIterateInterval
+    ), cCbsCallInterval);
+
+    // The friends are read here, then their vcards are parsed in a worker
+    // thread while the models which don't use the contacts are created.
+    QList<ContactsListModel::FriendData> friends;
+    {
+      StartupProfiler::Span span("ContactsListModel::readFriends");
+      friends = ContactsListModel::readFriends();
+    }
+    QFuture<void> friendsParsing = QtConcurrent::run(&ContactsListModel::parseFriends, &friends);
+
+    {
+      StartupProfiler::Span span("CallsListModel");
+      mInstance->mCallsListModel = new CallsListModel(mInstance);
+    }
+    {
+      StartupProfiler::Span span("SettingsModel");
+      mInstance->mSettingsModel = new SettingsModel(mInstance);
+    }
+    {
+      StartupProfiler::Span span("AccountSettingsModel");
+      mInstance->mAccountSettingsModel = new AccountSettingsModel(mInstance);
+    }
+    {
+      StartupProfiler::Span span("ContactsListModel");
+      friendsParsing.waitForFinished();
+      mInstance->mContactsListModel = new ContactsListModel(mInstance, friends);
+    }
+    {
+      StartupProfiler::Span span("SipAddressesModel");
+      mInstance->mSipAddressesModel = new SipAddressesModel(mInstance, mInstance->mPromiseSnapshot.result());
+      // The snapshot is owned by the model now, release the result of the future.
+      mInstance->mPromiseSnapshot = QFuture<QHash<QString, QVariantMap> >();
+    }
+    {
+      StartupProfiler::Span span("CoreManager::migrate");
+      mInstance->migrate();
+    }
 
-    mInstance->migrate();
+    QTimer::singleShot(cThumbnailsCheckDelay, mInstance, &CoreManager::startThumbnailsCheck);
 
     mInstance->mStarted = true;
     emit mInstance->coreStarted();
   });
 
+  // Signaling events. The presences are not taken into account, they are
+  // received all the time and don't need a fast answer.
+  auto notifyCoreActivity = [this] {
+      this->notifyCoreActivity();
+    };
+  QObject::connect(coreHandlers, &CoreHandlers::authenticationRequested, this, notifyCoreActivity);
+  QObject::connect(coreHandlers, &CoreHandlers::callStateChanged, this, notifyCoreActivity);
+  QObject::connect(coreHandlers, &CoreHandlers::isComposingChanged, this, notifyCoreActivity);
+  QObject::connect(coreHandlers, &CoreHandlers::messageReceived, this, notifyCoreActivity);
+  QObject::connect(coreHandlers, &CoreHandlers::registrationStateChanged, this, notifyCoreActivity);
+
+  QObject::connect(coreHandlers, &CoreHandlers::callStateChanged, this, &CoreManager::handleCallStateChanged);
+  QObject::connect(coreHandlers, &CoreHandlers::isComposingChanged, this, &CoreManager::handleIsComposingChanged);
+  QObject::connect(coreHandlers, &CoreHandlers::messageReceived, this, &CoreManager::handleMessageReceived);
+
   QObject::connect(
     coreHandlers, &CoreHandlers::logsUploadStateChanged,
     this, &CoreManager::handleLogsUploadStateChanged
@@ -98,6 +177,12 @@ CoreManager::CoreManager (QObject *parent, const QString &configPath) :
   mPromiseWatcher.setFuture(mPromiseBuild);
 }
 
+CoreManager::~CoreManager () {
+  // The thumbnails cache is used by the generator and the sweep.
+  delete mThumbnailGenerator;
+  mPromiseSweep.waitForFinished();
+}
+
 // -----------------------------------------------------------------------------
 
 shared_ptr<ChatModel> CoreManager::getChatModelFromSipAddress (const QString &sipAddress) {
@@ -127,6 +212,46 @@ shared_ptr<ChatModel> CoreManager::getChatModelFromSipAddress (const QString &si
   return chatModel;
 }
 
+shared_ptr<ChatModel> CoreManager::getRoutedChatModel (const shared_ptr<linphone::ChatRoom> &chatRoom) {
+  if (mChatModels.isEmpty() || !chatRoom)
+    return nullptr;
+
+  auto it = mChatModels.find(::Utils::coreStringToAppString(chatRoom->getPeerAddress()->asStringUriOnly()));
+  shared_ptr<ChatModel> chatModel = it == mChatModels.end() ? nullptr : it->lock();
+
+  const int count = mChatModels.count();
+  if (chatModel) {
+    ++mChatEventsDeliveredCount;
+    mChatEventsFilteredCount += quint64(count - 1);
+  } else
+    mChatEventsFilteredCount += quint64(count);
+
+  return chatModel;
+}
+
+void CoreManager::handleCallStateChanged (const shared_ptr<linphone::Call> &call, linphone::CallState state) {
+  // Only the ended calls are displayed in the chat models. The remote address of
+  // a call can be written differently than the peer address of its chat room.
+  if (mChatModels.isEmpty() || (state != linphone::CallStateEnd && state != linphone::CallStateError))
+    return;
+
+  shared_ptr<ChatModel> chatModel = getRoutedChatModel(mCore->getChatRoom(call->getRemoteAddress()));
+  if (chatModel)
+    chatModel->handleCallStateChanged(call, state);
+}
+
+void CoreManager::handleIsComposingChanged (const shared_ptr<linphone::ChatRoom> &chatRoom) {
+  shared_ptr<ChatModel> chatModel = getRoutedChatModel(chatRoom);
+  if (chatModel)
+    chatModel->handleIsComposingChanged();
+}
+
+void CoreManager::handleMessageReceived (const shared_ptr<linphone::ChatMessage> &message) {
+  shared_ptr<ChatModel> chatModel = getRoutedChatModel(message->getChatRoom());
+  if (chatModel)
+    chatModel->handleMessageReceived(message);
+}
+
 // -----------------------------------------------------------------------------
 
 void CoreManager::init (QObject *parent, const QString &configPath) {
@@ -139,10 +264,18 @@ void CoreManager::init (QObject *parent, const QString &configPath) {
   timer->setInterval(cCbsCallInterval);
 
   QObject::connect(timer, &QTimer::timeout, mInstance, &CoreManager::iterate);
+
+  mInstance->mIterateClock.start();
 }
 
 void CoreManager::uninit () {
   if (mInstance) {
+    qInfo() << mInstance->mIterateLateness.toString();
+    qInfo() << mInstance->mIterateDuration.toString();
+    qInfo() << mInstance->mCallbackDeliveryLatency.toString();
+    qInfo() << QStringLiteral("Chat events delivered: %1, filtered: %2.")
+      .arg(mInstance->mChatEventsDeliveredCount).arg(mInstance->mChatEventsFilteredCount);
+
     delete mInstance;
     mInstance = nullptr;
   }
@@ -220,6 +353,8 @@ void CoreManager::setResourcesPaths () {
 // -----------------------------------------------------------------------------
 
 void CoreManager::createLinphoneCore (const QString &configPath) {
+  StartupProfiler::Span span("CoreManager::createLinphoneCore");
+
   qInfo() << QStringLiteral("Launch async linphone core creation.");
 
   // Migration of configuration and database files from GTK version of Linphone.
@@ -279,14 +414,157 @@ QString CoreManager::getVersion () const {
 
 // -----------------------------------------------------------------------------
 
+double CoreManager::getIterateRate () const {
+  const qint64 elapsed = mIterateClock.elapsed() - mLastIterateStatsLog;
+  return elapsed > 0 ? mIterateCount * 1000.0 / elapsed : 0.0;
+}
+
+void CoreManager::notifyCoreActivity () {
+  mLastCoreActivity = mIterateClock.elapsed();
+  if (mIterateMode == IterateModeIdle)
+    updateIterateMode();
+}
+
+void CoreManager::markCoreCallback () {
+  QMetaObject::invokeMethod(
+    this, "handleCoreCallbackDelivered", Qt::QueuedConnection,
+    Q_ARG(qint64, mIterateClock.nsecsElapsed() / 1000)
+  );
+}
+
+// -----------------------------------------------------------------------------
+
 void CoreManager::iterate () {
+  const qint64 start = mIterateClock.nsecsElapsed() / 1000;
+  if (mLastIterateStart >= 0)
+    mIterateLateness.add(qMax(start - mLastIterateStart - mCbsTimer->interval() * 1000, qint64(0)));
+  mLastIterateStart = start;
+  ++mIterateCount;
+
   mInstance->lockVideoRender();
   mCore->iterate();
   mInstance->unlockVideoRender();
+
+  const qint64 end = mIterateClock.nsecsElapsed() / 1000;
+  mIterateDuration.add(end - start);
+
+  if (end / 1000 - mLastIterateStatsLog >= cIterateStatsLogInterval) {
+    qInfo() << QStringLiteral("Iterate mode: %1, rate: %2/s.")
+      .arg(mIterateMode == IterateModeActive ? QStringLiteral("active") : QStringLiteral("idle"))
+      .arg(getIterateRate(), 0, 'f', 1);
+    qInfo() << mIterateLateness.toString();
+    qInfo() << mIterateDuration.toString();
+    qInfo() << mCallbackDeliveryLatency.toString();
+
+    mIterateLateness.reset();
+    mIterateDuration.reset();
+    mCallbackDeliveryLatency.reset();
+    mIterateCount = 0;
+    mLastIterateStatsLog = end / 1000;
+  }
+
+  updateIterateMode();
+}
+
+void CoreManager::updateIterateMode () {
+  // The core is not started: the models are not created yet.
+  if (!mStarted || !mIdleIterateInterval)
+    return;
+
+  const IterateMode mode = mCore->getCallsNb() > 0 ||
+    mIterateClock.elapsed() - mLastCoreActivity < cCoreActivityDuration
+    ? IterateModeActive
+    : IterateModeIdle;
+  if (mode == mIterateMode)
+    return;
+
+  mIterateMode = mode;
+  mCbsTimer->setInterval(mode == IterateModeActive ? cCbsCallInterval : mIdleIterateInterval);
+
+  // Don't measure the mode change as a lateness.
+  mLastIterateStart = -1;
+
+  qInfo() << QStringLiteral("Use %1 iterate interval: %2ms.")
+    .arg(mode == IterateModeActive ? QStringLiteral("active") : QStringLiteral("idle"))
+    .arg(mCbsTimer->interval());
+}
+
+// -----------------------------------------------------------------------------
+
+void CoreManager::startThumbnailsCheck () {
+  const qint64 now = QDateTime::currentMSecsSinceEpoch() / 1000;
+  if (now - mCore->getConfig()->getInt64(SettingsModel::UI_SECTION, cThumbnailsLastCheckName, 0) < cThumbnailsCheckInterval)
+    return;
+
+  // The thumbnail of a pending job is not yet referenced by its message.
+  if (mThumbnailGenerator->hasPendingJobs()) {
+    QTimer::singleShot(cThumbnailsCheckDelay, this, &CoreManager::startThumbnailsCheck);
+    return;
+  }
+
+  qInfo() << QStringLiteral("Check thumbnails references.");
+
+  mThumbnailsCheckChatRooms.clear();
+  for (const auto &chatRoom : mCore->getChatRooms())
+    mThumbnailsCheckChatRooms << chatRoom;
+  mThumbnailsCheckPosition = 0;
+  mThumbnailsCheckJobsCount = mThumbnailGenerator->getJobsCount();
+  mThumbnailsCheckRemovedCount = mRemovedMessagesCount;
+  mThumbnailsRefs.clear();
+
+  QTimer::singleShot(0, this, &CoreManager::checkThumbnailsReferences);
+}
+
+void CoreManager::checkThumbnailsReferences () {
+  // One history page per event loop iteration. The position is counted from the
+  // oldest message: a received message doesn't shift the unread messages.
+  if (!mThumbnailsCheckChatRooms.isEmpty()) {
+    const shared_ptr<linphone::ChatRoom> &chatRoom = mThumbnailsCheckChatRooms.first();
+    const int end = chatRoom->getHistorySize() - mThumbnailsCheckPosition - 1;
+    const int begin = qMax(0, end - cThumbnailsCheckPageSize + 1);
+
+    if (end >= 0) {
+      for (const auto &message : chatRoom->getHistoryRange(begin, end)) {
+        const QString fileId = ::Utils::coreStringToAppString(message->getAppdata()).section(':', 0, 0);
+        if (!fileId.isEmpty())
+          ++mThumbnailsRefs[fileId];
+      }
+      mThumbnailsCheckPosition += end - begin + 1;
+    }
+
+    if (begin == 0) {
+      mThumbnailsCheckChatRooms.removeFirst();
+      mThumbnailsCheckPosition = 0;
+    }
+
+    QTimer::singleShot(0, this, &CoreManager::checkThumbnailsReferences);
+    return;
+  }
+
+  // A thumbnail was created or a message was removed during the check
+  // (a removed message shifts the unread messages), retry at the next start.
+  if (
+    mThumbnailGenerator->hasPendingJobs() ||
+    mThumbnailGenerator->getJobsCount() != mThumbnailsCheckJobsCount ||
+    mRemovedMessagesCount != mThumbnailsCheckRemovedCount
+  )
+    qInfo() << QStringLiteral("Thumbnails references check aborted.");
+  else {
+    mThumbnailsCache->reconcile(mThumbnailsRefs);
+    mCore->getConfig()->setInt64(
+      SettingsModel::UI_SECTION, cThumbnailsLastCheckName, QDateTime::currentMSecsSinceEpoch() / 1000
+    );
+  }
+
+  mThumbnailsRefs.clear();
 }
 
 // -----------------------------------------------------------------------------
 
+void CoreManager::handleCoreCallbackDelivered (qint64 callback) {
+  mCallbackDeliveryLatency.add(mIterateClock.nsecsElapsed() / 1000 - callback);
+}
+
 void CoreManager::handleLogsUploadStateChanged (linphone::CoreLogCollectionUploadState state, const string &info) {
   switch (state) {
     case linphone::CoreLogCollectionUploadStateInProgress:
@@ -23,10 +23,14 @@
 #ifndef CORE_MANAGER_H_
 #define CORE_MANAGER_H_
 
+#include <QElapsedTimer>
 #include <QFutureWatcher>
 
+#include "../../utils/LatencyHistogram.hpp"
 #include "../calls/CallsListModel.hpp"
 #include "../chat/ChatModel.hpp"
+#include "../chat/ThumbnailGenerator.hpp"
+#include "../chat/ThumbnailsCache.hpp"
 #include "../contacts/ContactsListModel.hpp"
 #include "../settings/AccountSettingsModel.hpp"
 #include "../settings/SettingsModel.hpp"
@@ -45,7 +49,7 @@ class CoreManager : public QObject {
   Q_PROPERTY(QString downloadUrl READ getDownloadUrl CONSTANT);
 
 public:
-  ~CoreManager () = default;
+  ~CoreManager ();
 
   bool started () const {
     return mStarted;
@@ -63,6 +67,16 @@ public:
 
   std::shared_ptr<ChatModel> getChatModelFromSipAddress (const QString &sipAddress);
 
+  // Chat room events delivered to their chat model and deliveries avoided
+  // compared to a broadcast to all the chat models.
+  quint64 getChatEventsDeliveredCount () const {
+    return mChatEventsDeliveredCount;
+  }
+
+  quint64 getChatEventsFilteredCount () const {
+    return mChatEventsFilteredCount;
+  }
+
   // ---------------------------------------------------------------------------
   // Video render lock.
   // ---------------------------------------------------------------------------
@@ -104,6 +118,47 @@ public:
     return mAccountSettingsModel;
   }
 
+  ThumbnailsCache *getThumbnailsCache () const {
+    Q_CHECK_PTR(mThumbnailsCache);
+    return mThumbnailsCache;
+  }
+
+  ThumbnailGenerator *getThumbnailGenerator () const {
+    Q_CHECK_PTR(mThumbnailGenerator);
+    return mThumbnailGenerator;
+  }
+
+  // ---------------------------------------------------------------------------
+  // Iterate scheduling.
+  // ---------------------------------------------------------------------------
+
+  enum IterateMode {
+    IterateModeActive,
+    IterateModeIdle
+  };
+
+  IterateMode getIterateMode () const {
+    return mIterateMode;
+  }
+
+  // Iterate calls per second since the last statistics log.
+  double getIterateRate () const;
+
+  // Use the active iterate interval during a short period.
+  // Must be called when a call, a message or a file transfer progresses.
+  void notifyCoreActivity ();
+
+  // Post an event from a core callback (call state, message, composing). Its
+  // delivery latency is the delay of a callback queued to the GUI thread:
+  // the end of the iterate and the events already pending.
+  void markCoreCallback ();
+
+  // Must be called when messages are deleted from a chat room history.
+  // A running thumbnails references check is aborted.
+  void notifyMessagesRemoved () {
+    ++mRemovedMessagesCount;
+  }
+
   // ---------------------------------------------------------------------------
   // Initialization.
   // ---------------------------------------------------------------------------
@@ -148,9 +203,22 @@ private:
   QString getVersion () const;
 
   void iterate ();
+  void updateIterateMode ();
+
+  void startThumbnailsCheck ();
+  void checkThumbnailsReferences ();
+
+  // Uses the key of the chat models registration: the peer address of their chat room.
+  std::shared_ptr<ChatModel> getRoutedChatModel (const std::shared_ptr<linphone::ChatRoom> &chatRoom);
+
+  void handleCallStateChanged (const std::shared_ptr<linphone::Call> &call, linphone::CallState state);
+  void handleIsComposingChanged (const std::shared_ptr<linphone::ChatRoom> &chatRoom);
+  void handleMessageReceived (const std::shared_ptr<linphone::ChatMessage> &message);
 
   void handleLogsUploadStateChanged (linphone::CoreLogCollectionUploadState state, const std::string &info);
 
+  Q_INVOKABLE void handleCoreCallbackDelivered (qint64 callback);
+
   static QString getDownloadUrl ();
 
   std::shared_ptr<linphone::Core> mCore;
@@ -163,14 +231,47 @@ private:
   SipAddressesModel *mSipAddressesModel = nullptr;
   SettingsModel *mSettingsModel = nullptr;
   AccountSettingsModel *mAccountSettingsModel = nullptr;
-
+  ThumbnailsCache *mThumbnailsCache = nullptr;
+  ThumbnailGenerator *mThumbnailGenerator = nullptr;
+
+  // Check of the thumbnails references count, with the app data of the messages.
+  QList<std::shared_ptr<linphone::ChatRoom> > mThumbnailsCheckChatRooms;
+  QHash<QString, int> mThumbnailsRefs;
+  int mThumbnailsCheckPosition = 0;
+  int mThumbnailsCheckJobsCount = 0;
+  quint64 mThumbnailsCheckRemovedCount = 0;
+  quint64 mRemovedMessagesCount = 0;
+
+  // Peer address => chat model. Used to route the chat room events.
   QHash<QString, std::weak_ptr<ChatModel> > mChatModels;
+  quint64 mChatEventsDeliveredCount = 0;
+  quint64 mChatEventsFilteredCount = 0;
 
   QTimer *mCbsTimer = nullptr;
 
+  // The iterate interval is relaxed when there is no call and no recent activity.
+  IterateMode mIterateMode = IterateModeActive;
+  int mIdleIterateInterval = 0;
+  qint64 mLastCoreActivity = 0;
+  int mIterateCount = 0;
+
+  // Iterate statistics. The lateness is the delay of the iterate calls caused
+  // by the other tasks of the GUI thread, the duration includes the callbacks.
+  QElapsedTimer mIterateClock;
+  qint64 mLastIterateStart = -1;
+  qint64 mLastIterateStatsLog = 0;
+  LatencyHistogram mIterateLateness { QStringLiteral("Iterate lateness") };
+  LatencyHistogram mIterateDuration { QStringLiteral("Iterate duration") };
+
+  LatencyHistogram mCallbackDeliveryLatency { QStringLiteral("Callback delivery latency") };
+
   QFuture<void> mPromiseBuild;
   QFutureWatcher<void> mPromiseWatcher;
 
+  // Startup work which doesn't use the core, done in worker threads.
+  QFuture<QHash<QString, QVariantMap> > mPromiseSnapshot;
+  QFuture<void> mPromiseSweep;
+
   QMutex mMutexVideoRender;
 
   static CoreManager *mInstance;
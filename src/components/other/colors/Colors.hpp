@@ -24,6 +24,7 @@
 #define COLORS_H_
 
 #include <linphone++/linphone.hh>
+#include <QAtomicInt>
 #include <QColor>
 #include <QObject>
 
@@ -32,6 +33,8 @@
 #define ADD_COLOR(COLOR, VALUE) \
   Q_PROPERTY(QColor COLOR MEMBER m ## COLOR WRITE set ## COLOR NOTIFY colorT ## COLOR ## Changed); \
   void set ## COLOR(const QColor &color) { \
+    if (m ## COLOR != color) \
+      mGeneration.ref(); \
     m ## COLOR = color; \
     emit colorT ## COLOR ## Changed(m ## COLOR); \
   } \
@@ -101,6 +104,11 @@ public:
 
   void useConfig (const std::shared_ptr<linphone::Config> &config);
 
+  // Incremented each time a color is changed. Thread-safe.
+  int getGeneration () const {
+    return mGeneration.load();
+  }
+
 signals:
   void colorTaChanged (const QColor &color);
   void colorTbChanged (const QColor &color);
@@ -135,6 +143,8 @@ private:
   void overrideColors (const std::shared_ptr<linphone::Config> &config);
 
   QStringList getColorNames () const;
+
+  QAtomicInt mGeneration;
 };
 
 // -----------------------------------------------------------------------------
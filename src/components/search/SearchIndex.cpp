@@ -0,0 +1,206 @@
+/*
+ * SearchIndex.cpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#include <QSet>
+
+#include "SearchIndex.hpp"
+
+// =============================================================================
+
+namespace {
+  constexpr int cTrigramSize = 3;
+
+  // Compact the index when there are more removed documents than valid ones.
+  constexpr int cMinRemovedCountToCompact = 1024;
+
+  // Separators of words. The chars of the previous `[_.-;@ ]` pattern, where
+  // `.-;` is the range `./0123456789:;`, and the `-` char itself.
+  const QString cSeparators("_.-/0123456789:;@ ");
+}
+
+static inline QString normalize (const QString &string) {
+  return string.toLower();
+}
+
+static inline quint64 getTrigram (const QString &string, int index) {
+  return (quint64(string.at(index).unicode()) << 32) |
+    (quint64(string.at(index + 1).unicode()) << 16) |
+    quint64(string.at(index + 2).unicode());
+}
+
+// -----------------------------------------------------------------------------
+
+void SearchIndex::insert (const QString &key, const QStringList &fields) {
+  QStringList normalizedFields;
+  for (const QString &field : fields)
+    normalizedFields << normalize(field);
+
+  auto it = mKeys.find(key);
+  if (it != mKeys.end()) {
+    Document &document = mDocuments[it.value()];
+    if (document.fields == normalizedFields)
+      return;
+
+    document.removed = true;
+    ++mRemovedCount;
+  } else
+    it = mKeys.insert(key, -1);
+
+  Document document;
+  document.key = key;
+  document.fields = normalizedFields;
+
+  *it = mDocuments.count();
+  mDocuments << document;
+  indexDocument(*it);
+
+  if (mRemovedCount > cMinRemovedCountToCompact && mRemovedCount > mKeys.count())
+    compact();
+}
+
+void SearchIndex::remove (const QString &key) {
+  auto it = mKeys.find(key);
+  if (it == mKeys.end())
+    return;
+
+  mDocuments[it.value()].removed = true;
+  ++mRemovedCount;
+  mKeys.erase(it);
+
+  if (mRemovedCount > cMinRemovedCountToCompact && mRemovedCount > mKeys.count())
+    compact();
+}
+
+void SearchIndex::clear () {
+  mDocuments.clear();
+  mRemovedCount = 0;
+  mKeys.clear();
+  mPostings.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+QHash<QString, SearchIndex::Match> SearchIndex::search (const QString &pattern) const {
+  const QString normalizedPattern = normalize(pattern);
+  QHash<QString, Match> matches;
+  Match match;
+
+  // Too short to use the trigrams.
+  if (normalizedPattern.length() < cTrigramSize) {
+    for (const Document &document : mDocuments)
+      if (!document.removed && matchDocument(document, normalizedPattern, match))
+        matches.insert(document.key, match);
+    return matches;
+  }
+
+  // Use the smallest postings list of the pattern trigrams. The candidates are checked after.
+  const QVector<int> *candidates = nullptr;
+  for (int i = 0; i <= normalizedPattern.length() - cTrigramSize; ++i) {
+    auto it = mPostings.constFind(getTrigram(normalizedPattern, i));
+    if (it == mPostings.cend())
+      return matches;
+
+    if (!candidates || it->count() < candidates->count())
+      candidates = &(*it);
+  }
+
+  for (int id : *candidates) {
+    const Document &document = mDocuments[id];
+    if (!document.removed && matchDocument(document, normalizedPattern, match))
+      matches.insert(document.key, match);
+  }
+
+  return matches;
+}
+
+SearchIndex::Match SearchIndex::match (const QString &key, const QString &pattern) const {
+  Match match;
+
+  auto it = mKeys.constFind(key);
+  if (it == mKeys.cend() || !matchDocument(mDocuments[it.value()], normalize(pattern), match))
+    match.clear();
+
+  return match;
+}
+
+// -----------------------------------------------------------------------------
+
+void SearchIndex::indexDocument (int id) {
+  QSet<quint64> trigrams;
+  for (const QString &field : mDocuments[id].fields)
+    for (int i = 0; i <= field.length() - cTrigramSize; ++i)
+      trigrams << getTrigram(field, i);
+
+  for (quint64 trigram : trigrams)
+    mPostings[trigram] << id;
+}
+
+void SearchIndex::compact () {
+  QVector<Document> documents;
+  documents.reserve(mKeys.count());
+
+  for (const Document &document : mDocuments)
+    if (!document.removed) {
+      mKeys[document.key] = documents.count();
+      documents << document;
+    }
+
+  mDocuments.swap(documents);
+  mRemovedCount = 0;
+
+  mPostings.clear();
+  for (int id = 0; id < mDocuments.count(); ++id)
+    indexDocument(id);
+}
+
+// -----------------------------------------------------------------------------
+
+bool SearchIndex::matchDocument (const Document &document, const QString &pattern, Match &match) {
+  bool found = false;
+
+  match.resize(document.fields.count());
+  for (int i = 0; i < document.fields.count(); ++i)
+    if ((match[i] = matchField(document.fields[i], pattern)) != -1)
+      found = true;
+
+  return found;
+}
+
+int SearchIndex::matchField (const QString &field, const QString &pattern) {
+  if (field.isEmpty())
+    return -1;
+
+  int index = -1;
+  int offset = -1;
+
+  while ((index = field.indexOf(pattern, index + 1)) != -1) {
+    // Search n chars between the start of the word and index.
+    int start = index;
+    while (start > 0 && !cSeparators.contains(field.at(start - 1)))
+      --start;
+
+    if (offset == -1 || index - start < offset)
+      if ((offset = index - start) == 0)
+        break;
+  }
+
+  return offset;
+}
@@ -0,0 +1,81 @@
+/*
+ * SearchIndex.hpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef SEARCH_INDEX_H_
+#define SEARCH_INDEX_H_
+
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+// =============================================================================
+// Case insensitive substring search on documents made of several fields.
+// Documents are lowercased once and indexed by trigrams.
+// =============================================================================
+
+class SearchIndex {
+public:
+  // Offset of the best match in each field, from the start of the matched
+  // word. -1 if the field doesn't match.
+  typedef QVector<int> Match;
+
+  SearchIndex () = default;
+  ~SearchIndex () = default;
+
+  // Add or replace a document.
+  void insert (const QString &key, const QStringList &fields);
+  void remove (const QString &key);
+  void clear ();
+
+  int count () const {
+    return mKeys.count();
+  }
+
+  // Returns the matching documents. An empty pattern matches all documents.
+  QHash<QString, Match> search (const QString &pattern) const;
+
+  // Returns an empty match if the document doesn't match or doesn't exist.
+  Match match (const QString &key, const QString &pattern) const;
+
+private:
+  struct Document {
+    QString key;
+    QStringList fields;
+    bool removed = false;
+  };
+
+  void indexDocument (int id);
+  void compact ();
+
+  static bool matchDocument (const Document &document, const QString &pattern, Match &match);
+  static int matchField (const QString &field, const QString &pattern);
+
+  QVector<Document> mDocuments;
+  int mRemovedCount = 0;
+
+  // Key => id in `mDocuments`.
+  QHash<QString, int> mKeys;
+
+  // Trigram => ids of the documents which contain it. Can contain removed documents.
+  QHash<quint64, QVector<int> > mPostings;
+};
+
+#endif // SEARCH_INDEX_H_
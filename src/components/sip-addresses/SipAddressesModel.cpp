@@ -20,9 +20,20 @@
  *      Author: Ronan Abhamon
  */
 
+#include <algorithm>
+
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QtConcurrent>
+#include <QTimer>
+
+#include "../../app/paths/Paths.hpp"
 
 #include "../../utils/LinphoneUtils.hpp"
+#include "../../utils/StartupProfiler.hpp"
 #include "../../utils/Utils.hpp"
 #include "../core/CoreManager.hpp"
 
@@ -30,10 +41,51 @@
 
 using namespace std;
 
+namespace {
+  // In milliseconds.
+  constexpr int cSnapshotInterval = 5 * 60 * 1000;
+}
+
 // =============================================================================
 
-SipAddressesModel::SipAddressesModel (QObject *parent) : QAbstractListModel(parent) {
-  initSipAddresses();
+// Returns the sip addresses of the call logs with the time of their last call.
+// Only the call logs are read, the core is not used: it can be called in a
+// worker thread while the GUI thread reads the chat rooms.
+static QHash<QString, QVariantMap> summarizeCallLogs (const list<shared_ptr<linphone::CallLog> > *callLogs) {
+  QHash<QString, QVariantMap> sipAddresses;
+
+  // Call logs are sorted from the most recent, so only the first log of each peer is used.
+  for (const auto &callLog : *callLogs) {
+    if (callLog->getStatus() == linphone::CallStatusAborted)
+      continue; // Ignore aborted calls.
+
+    const QString sipAddress = ::Utils::coreStringToAppString(callLog->getRemoteAddress()->asStringUriOnly());
+    if (sipAddresses.contains(sipAddress))
+      continue; // Already used.
+
+    QVariantMap map;
+    map["sipAddress"] = sipAddress;
+
+    // The duration can be wrong if status is not success.
+    map["timestamp"] = callLog->getStatus() == linphone::CallStatus::CallStatusSuccess
+      ? QDateTime::fromMSecsSinceEpoch((callLog->getStartDate() + callLog->getDuration()) * 1000)
+      : QDateTime::fromMSecsSinceEpoch(callLog->getStartDate() * 1000);
+
+    sipAddresses[sipAddress] = map;
+  }
+
+  return sipAddresses;
+}
+
+// -----------------------------------------------------------------------------
+
+SipAddressesModel::SipAddressesModel (QObject *parent, const QHash<QString, QVariantMap> &snapshot) : QAbstractListModel(parent) {
+  initSipAddresses(snapshot);
+
+  mPresenceTimer = new QTimer(this);
+  mPresenceTimer->setSingleShot(true);
+  mPresenceTimer->setInterval(0);
+  QObject::connect(mPresenceTimer, &QTimer::timeout, this, &SipAddressesModel::handlePresenceTimeout);
 
   CoreManager *coreManager = CoreManager::getInstance();
 
@@ -43,7 +95,9 @@ SipAddressesModel::SipAddressesModel (QObject *parent) : QAbstractListModel(pare
 
   ContactsListModel *contacts = CoreManager::getInstance()->getContactsListModel();
   QObject::connect(contacts, &ContactsListModel::contactAdded, this, &SipAddressesModel::handleContactAdded);
+  QObject::connect(contacts, &ContactsListModel::contactsAdded, this, &SipAddressesModel::handleContactsAdded);
   QObject::connect(contacts, &ContactsListModel::contactRemoved, this, &SipAddressesModel::handleContactRemoved);
+  QObject::connect(contacts, &ContactsListModel::contactUpdated, this, &SipAddressesModel::handleContactUpdated);
   QObject::connect(contacts, &ContactsListModel::sipAddressAdded, this, &SipAddressesModel::handleSipAddressAdded);
   QObject::connect(contacts, &ContactsListModel::sipAddressRemoved, this, &SipAddressesModel::handleSipAddressRemoved);
 
@@ -52,6 +106,15 @@ SipAddressesModel::SipAddressesModel (QObject *parent) : QAbstractListModel(pare
   QObject::connect(coreHandlers, &CoreHandlers::callStateChanged, this, &SipAddressesModel::handleCallStateChanged);
   QObject::connect(coreHandlers, &CoreHandlers::presenceReceived, this, &SipAddressesModel::handlePresenceReceived);
   QObject::connect(coreHandlers, &CoreHandlers::isComposingChanged, this, &SipAddressesModel::handlerIsComposingChanged);
+
+  mSnapshotTimer = new QTimer(this);
+  mSnapshotTimer->setInterval(cSnapshotInterval);
+  QObject::connect(mSnapshotTimer, &QTimer::timeout, this, &SipAddressesModel::saveSnapshot);
+  mSnapshotTimer->start();
+}
+
+SipAddressesModel::~SipAddressesModel () {
+  saveSnapshot();
 }
 
 // -----------------------------------------------------------------------------
@@ -218,8 +281,14 @@ bool SipAddressesModel::removeRows (int row, int count, const QModelIndex &paren
 
     qInfo() << QStringLiteral("Remove sip address: `%1`.").arg(sipAddress);
     mSipAddresses.remove(sipAddress);
+    mRows.remove(sipAddress);
+    mSearchIndex.remove(sipAddress);
   }
 
+  // Update the rows of the next sip addresses.
+  for (int i = row; i < mRefs.count(); ++i)
+    mRows[(*mRefs[i])["sipAddress"].toString()] = i;
+
   endRemoveRows();
 
   return true;
@@ -242,15 +311,77 @@ void SipAddressesModel::handleChatModelCreated (const shared_ptr<ChatModel> &cha
 }
 
 void SipAddressesModel::handleContactAdded (ContactModel *contact) {
-  for (const auto &sipAddress : contact->getVcardModel()->getSipAddresses())
+  for (const auto &sipAddress : contact->getSipAddresses())
     addOrUpdateSipAddress(sipAddress.toString(), contact);
 }
 
+void SipAddressesModel::handleContactsAdded (const QList<ContactModel *> &contacts) {
+  QVector<int> changedRows;
+  QStringList newSipAddresses;
+  QHash<QString, QVariantMap> newMaps;
+
+  for (ContactModel *contact : contacts)
+    for (const auto &variant : contact->getSipAddresses()) {
+      const QString sipAddress = variant.toString();
+
+      auto it = mSipAddresses.find(sipAddress);
+      if (it != mSipAddresses.end()) {
+        addOrUpdateSipAddress(*it, contact);
+        updateSearchIndex(*it);
+        changedRows << mRows.value(it.key(), -1);
+        continue;
+      }
+
+      auto newIt = newMaps.find(sipAddress);
+      if (newIt == newMaps.end()) {
+        newIt = newMaps.insert(sipAddress, QVariantMap());
+        (*newIt)["sipAddress"] = sipAddress;
+        newSipAddresses << sipAddress;
+      }
+      addOrUpdateSipAddress(*newIt, contact);
+    }
+
+  emitRowsChanged(changedRows);
+
+  // Insert the new sip addresses in one range.
+  if (!newSipAddresses.isEmpty()) {
+    int row = mRefs.count();
+    beginInsertRows(QModelIndex(), row, row + newSipAddresses.count() - 1);
+
+    for (const QString &sipAddress : newSipAddresses) {
+      auto it = mSipAddresses.insert(sipAddress, newMaps[sipAddress]);
+      mRefs << &(*it);
+      mRows[sipAddress] = row++;
+      updateSearchIndex(*it);
+    }
+
+    endInsertRows();
+  }
+
+  qInfo() << QStringLiteral("Add %1 contacts: %2 sip addresses updated, %3 added.")
+    .arg(contacts.count()).arg(changedRows.count()).arg(newSipAddresses.count());
+}
+
 void SipAddressesModel::handleContactRemoved (const ContactModel *contact) {
-  for (const auto &sipAddress : contact->getVcardModel()->getSipAddresses())
+  for (const auto &sipAddress : contact->getSipAddresses())
     removeContactOfSipAddress(sipAddress.toString());
 }
 
+void SipAddressesModel::handleContactUpdated (ContactModel *contact) {
+  // The username can be changed.
+  for (const auto &sipAddress : contact->getSipAddresses()) {
+    auto it = mSipAddresses.find(sipAddress.toString());
+    if (it == mSipAddresses.end() || it->value("contact").value<ContactModel *>() != contact)
+      continue;
+
+    updateSearchIndex(*it);
+
+    int row = mRows.value(it.key(), -1);
+    Q_ASSERT(row != -1);
+    emit dataChanged(index(row, 0), index(row, 0));
+  }
+}
+
 void SipAddressesModel::handleSipAddressAdded (ContactModel *contact, const QString &sipAddress) {
   ContactModel *mappedContact = mapSipAddressToContact(sipAddress);
   if (mappedContact) {
@@ -311,17 +442,39 @@ void SipAddressesModel::handlePresenceReceived (
       break;
   }
 
-  auto it = mSipAddresses.find(sipAddress);
-  if (it != mSipAddresses.end()) {
-    qInfo() << QStringLiteral("Update presence of `%1`: %2.").arg(sipAddress).arg(status);
-    (*it)["presenceStatus"] = status;
+  // Last write wins. The flush is done at the next event loop iteration.
+  if (mPendingPresences.contains(sipAddress))
+    ++mCoalescedPresencesCount;
+  mPendingPresences[sipAddress] = status;
 
-    int row = mRefs.indexOf(&(*it));
-    Q_ASSERT(row != -1);
-    emit dataChanged(index(row, 0), index(row, 0));
+  if (!mPresenceTimer->isActive())
+    mPresenceTimer->start();
+}
+
+void SipAddressesModel::handlePresenceTimeout () {
+  QHash<QString, Presence::PresenceStatus> presences;
+  presences.swap(mPendingPresences);
+
+  QVector<int> rows;
+  rows.reserve(presences.count());
+
+  for (auto presence = presences.cbegin(); presence != presences.cend(); ++presence) {
+    auto it = mSipAddresses.find(presence.key());
+    if (it != mSipAddresses.end()) {
+      (*it)["presenceStatus"] = presence.value();
+
+      int row = mRows.value(it.key(), -1);
+      Q_ASSERT(row != -1);
+      rows << row;
+    }
+
+    updateObservers(presence.key(), presence.value());
   }
 
-  updateObservers(sipAddress, status);
+  emitRowsChanged(rows);
+
+  qInfo() << QStringLiteral("Update presence of %1 sip addresses (%2 rows, %3 coalesced updates since start).")
+    .arg(presences.count()).arg(rows.count()).arg(mCoalescedPresencesCount);
 }
 
 void SipAddressesModel::handleAllEntriesRemoved (const QString &sipAddress) {
@@ -331,7 +484,7 @@ void SipAddressesModel::handleAllEntriesRemoved (const QString &sipAddress) {
     return;
   }
 
-  int row = mRefs.indexOf(&(*it));
+  int row = mRows.value(it.key(), -1);
   Q_ASSERT(row != -1);
 
   // No history, no contact => Remove sip address from list.
@@ -357,7 +510,7 @@ void SipAddressesModel::handleMessagesCountReset (const QString &sipAddress) {
   if (it != mSipAddresses.end()) {
     (*it)["unreadMessagesCount"] = 0;
 
-    int row = mRefs.indexOf(&(*it));
+    int row = mRows.value(it.key(), -1);
     Q_ASSERT(row != -1);
     emit dataChanged(index(row, 0), index(row, 0));
   }
@@ -370,7 +523,7 @@ void SipAddressesModel::handlerIsComposingChanged (const shared_ptr<linphone::Ch
   if (it != mSipAddresses.end()) {
     (*it)["isComposing"] = chatRoom->isRemoteComposing();
 
-    int row = mRefs.indexOf(&(*it));
+    int row = mRows.value(it.key(), -1);
     Q_ASSERT(row != -1);
     emit dataChanged(index(row, 0), index(row, 0));
   }
@@ -411,8 +564,9 @@ void SipAddressesModel::addOrUpdateSipAddress (const QString &sipAddress, T data
   auto it = mSipAddresses.find(sipAddress);
   if (it != mSipAddresses.end()) {
     addOrUpdateSipAddress(*it, data);
+    updateSearchIndex(*it);
 
-    int row = mRefs.indexOf(&(*it));
+    int row = mRows.value(it.key(), -1);
     Q_ASSERT(row != -1);
     emit dataChanged(index(row, 0), index(row, 0));
 
@@ -431,6 +585,8 @@ void SipAddressesModel::addOrUpdateSipAddress (const QString &sipAddress, T data
 
   mSipAddresses[sipAddress] = map;
   mRefs << &mSipAddresses[sipAddress];
+  mRows[sipAddress] = row;
+  updateSearchIndex(map);
 
   endInsertRows();
 }
@@ -450,8 +606,9 @@ void SipAddressesModel::removeContactOfSipAddress (const QString &sipAddress) {
 
   qInfo() << QStringLiteral("Map new contact on sip address: `%1`.").arg(sipAddress) << contactModel;
   addOrUpdateSipAddress(*it, contactModel);
+  updateSearchIndex(*it);
 
-  int row = mRefs.indexOf(&(*it));
+  int row = mRows.value(it.key(), -1);
   Q_ASSERT(row != -1);
 
   // History exists, signal changes.
@@ -464,14 +621,57 @@ void SipAddressesModel::removeContactOfSipAddress (const QString &sipAddress) {
   removeRow(row);
 }
 
-void SipAddressesModel::initSipAddresses () {
+void SipAddressesModel::initSipAddresses (const QHash<QString, QVariantMap> &snapshot) {
+  QElapsedTimer timer;
+  timer.start();
+
+  const bool fromSnapshot = !snapshot.isEmpty();
+  mSipAddresses = fromSnapshot ? snapshot : fetchSipAddresses();
+
+  // The snapshot is shared with the caller: the hash must own its data before
+  // taking pointers to the values, a later detach would invalidate them.
+  mSipAddresses.detach();
+  for (auto it = mSipAddresses.begin(); it != mSipAddresses.end(); ++it) {
+    if (fromSnapshot)
+      mSnapshotContactKeys[it.key()] = it->take("contactKey").toString();
+
+    mRows[it.key()] = mRefs.count();
+    mRefs << &(*it);
+    updateSearchIndex(*it);
+  }
+
+  // Get sip addresses from contacts.
+  for (auto &contact : CoreManager::getInstance()->getContactsListModel()->mList)
+    handleContactAdded(contact);
+
+  qInfo() << QStringLiteral("Init %1 sip addresses from %2 in %3ms.")
+    .arg(mRefs.count()).arg(fromSnapshot ? QStringLiteral("snapshot") : QStringLiteral("history")).arg(timer.elapsed());
+
+  // The real history is scanned once the timeline is displayed.
+  if (fromSnapshot)
+    QTimer::singleShot(0, this, &SipAddressesModel::reconcileSnapshot);
+}
+
+QHash<QString, QVariantMap> SipAddressesModel::fetchSipAddresses () const {
   shared_ptr<linphone::Core> core = CoreManager::getInstance()->getCore();
+  QHash<QString, QVariantMap> sipAddresses;
+
+  QElapsedTimer timer;
+  timer.start();
+
+  // The call logs are summarized in a worker thread during the chat rooms scan.
+  // The list is released here, after the worker.
+  const list<shared_ptr<linphone::CallLog> > callLogs = core->getCallLogs();
+  QFuture<QHash<QString, QVariantMap> > callLogsSummary = QtConcurrent::run(::summarizeCallLogs, &callLogs);
 
   // Get sip addresses from chatrooms.
+  // Only the most recent message is fetched, the history is loaded by the chat models.
+  int chatRoomsCount = 0;
   for (const auto &chatRoom : core->getChatRooms()) {
-    list<shared_ptr<linphone::ChatMessage> > history = chatRoom->getHistory(0);
+    ++chatRoomsCount;
 
-    if (history.size() == 0)
+    list<shared_ptr<linphone::ChatMessage> > history = chatRoom->getHistoryRange(0, 0);
+    if (history.empty())
       continue;
 
     QString sipAddress = ::Utils::coreStringToAppString(chatRoom->getPeerAddress()->asStringUriOnly());
@@ -481,47 +681,201 @@ void SipAddressesModel::initSipAddresses () {
     map["timestamp"] = QDateTime::fromMSecsSinceEpoch(history.back()->getTime() * 1000);
     map["unreadMessagesCount"] = chatRoom->getUnreadMessagesCount();
 
-    mSipAddresses[sipAddress] = map;
+    sipAddresses[sipAddress] = map;
   }
+  const qint64 chatRoomsTime = timer.restart();
 
   // Get sip addresses from calls.
-  QSet<QString> addressDone;
-  for (const auto &callLog : core->getCallLogs()) {
-    const QString sipAddress = ::Utils::coreStringToAppString(callLog->getRemoteAddress()->asStringUriOnly());
+  const QHash<QString, QVariantMap> callsSipAddresses = callLogsSummary.result();
+  for (auto it = callsSipAddresses.cbegin(); it != callsSipAddresses.cend(); ++it) {
+    auto chatRoomIt = sipAddresses.find(it.key());
+    if (chatRoomIt == sipAddresses.end() || (*it)["timestamp"] > (*chatRoomIt)["timestamp"])
+      sipAddresses[it.key()] = *it;
+  }
+  const qint64 callLogsTime = timer.elapsed();
 
-    if (addressDone.contains(sipAddress))
-      continue; // Already used.
+  qInfo() << QStringLiteral("Fetch %1 sip addresses: %2 chat rooms in %3ms, %4 call logs in %5ms more.")
+    .arg(sipAddresses.count())
+    .arg(chatRoomsCount).arg(chatRoomsTime)
+    .arg(int(callLogs.size())).arg(callLogsTime);
 
-    if (callLog->getStatus() == linphone::CallStatusAborted)
-      continue; // Ignore aborted calls.
+  return sipAddresses;
+}
+
+// -----------------------------------------------------------------------------
+
+QHash<QString, QVariantMap> SipAddressesModel::readSnapshot () {
+  StartupProfiler::Span span("SipAddressesModel::readSnapshot");
+  QHash<QString, QVariantMap> sipAddresses;
 
-    addressDone << sipAddress;
+  QFile file(::Utils::coreStringToAppString(Paths::getTimelineSnapshotFilePath()));
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning() << QStringLiteral("Unable to read timeline snapshot: `%1`.").arg(file.fileName());
+    return sipAddresses;
+  }
+
+  // Empty on the first start.
+  if (file.size() == 0)
+    return sipAddresses;
+
+  QJsonParseError error;
+  const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &error);
+  if (error.error != QJsonParseError::NoError || !document.isArray()) {
+    qWarning() << QStringLiteral("Invalid timeline snapshot: `%1` (%2).").arg(file.fileName()).arg(error.errorString());
+    return sipAddresses;
+  }
+
+  // [sipAddress, timestamp, unreadMessagesCount or null, contactKey or null].
+  for (const QJsonValue &value : document.array()) {
+    const QJsonArray values = value.toArray();
+    const QString sipAddress = values.at(0).toString();
+    if (sipAddress.isEmpty())
+      continue;
 
     QVariantMap map;
     map["sipAddress"] = sipAddress;
+    map["timestamp"] = QDateTime::fromMSecsSinceEpoch(qint64(values.at(1).toDouble()));
+    if (values.at(2).isDouble())
+      map["unreadMessagesCount"] = values.at(2).toInt();
+    if (values.at(3).isString())
+      map["contactKey"] = values.at(3).toString();
 
-    // The duration can be wrong if status is not success.
-    map["timestamp"] = callLog->getStatus() == linphone::CallStatus::CallStatusSuccess
-      ? QDateTime::fromMSecsSinceEpoch((callLog->getStartDate() + callLog->getDuration()) * 1000)
-      : QDateTime::fromMSecsSinceEpoch(callLog->getStartDate() * 1000);
-
-    auto it = mSipAddresses.find(sipAddress);
-    if (it == mSipAddresses.end() || map["timestamp"] > (*it)["timestamp"])
-      mSipAddresses[sipAddress] = map;
+    sipAddresses[sipAddress] = map;
   }
 
+  return sipAddresses;
+}
+
+void SipAddressesModel::saveSnapshot () const {
+  QJsonArray snapshot;
   for (const auto &map : mSipAddresses) {
-    qInfo() << QStringLiteral("Add sip address: `%1`.").arg(map["sipAddress"].toString());
-    mRefs << &map;
+    auto it = map.constFind("timestamp");
+    if (it == map.cend())
+      continue; // No history.
+
+    QJsonArray values({ map["sipAddress"].toString(), double(it->toDateTime().toMSecsSinceEpoch()) });
+    auto count = map.constFind("unreadMessagesCount");
+    values.append(count != map.cend() ? QJsonValue(count->toInt()) : QJsonValue());
+    const ContactModel *contact = map.value("contact").value<ContactModel *>();
+    values.append(contact ? QJsonValue(contact->getUsername()) : QJsonValue());
+
+    snapshot.append(values);
   }
 
-  // Get sip addresses from contacts.
-  for (auto &contact : CoreManager::getInstance()->getContactsListModel()->mList)
-    handleContactAdded(contact);
+  QSaveFile file(::Utils::coreStringToAppString(Paths::getTimelineSnapshotFilePath()));
+  if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(snapshot).toJson(QJsonDocument::Compact)) < 0 || !file.commit())
+    qWarning() << QStringLiteral("Unable to write timeline snapshot: `%1`.").arg(file.fileName());
+}
+
+void SipAddressesModel::reconcileSnapshot () {
+  QHash<QString, QVariantMap> history = fetchSipAddresses();
+
+  QVector<int> changedRows;
+  QVector<int> removedRows;
+
+  for (auto it = mSipAddresses.begin(); it != mSipAddresses.end(); ++it) {
+    const int row = mRows.value(it.key(), -1);
+    Q_ASSERT(row != -1);
+
+    // The contact of the sip address was changed since the snapshot.
+    auto snapshotContactKey = mSnapshotContactKeys.constFind(it.key());
+    if (snapshotContactKey != mSnapshotContactKeys.cend()) {
+      const ContactModel *contact = it->value("contact").value<ContactModel *>();
+      if (*snapshotContactKey != (contact ? contact->getUsername() : QString()))
+        changedRows << row;
+    }
+
+    auto fetched = history.find(it.key());
+    if (fetched == history.end()) {
+      if (!it->contains("timestamp"))
+        continue; // Contact only.
+
+      // History removed since the snapshot. No history, no contact => Remove sip address.
+      if (it->contains("contact")) {
+        it->remove("timestamp");
+        it->remove("unreadMessagesCount");
+        changedRows << row;
+      } else
+        removedRows << row;
+      continue;
+    }
+
+    const int count = fetched->value("unreadMessagesCount", 0).toInt();
+    const int oldCount = it->value("unreadMessagesCount", 0).toInt();
+    if (it->value("timestamp") != fetched->value("timestamp") || count != oldCount) {
+      (*it)["timestamp"] = fetched->value("timestamp");
+      if (fetched->contains("unreadMessagesCount"))
+        (*it)["unreadMessagesCount"] = count;
+      else
+        it->remove("unreadMessagesCount");
+      changedRows << row;
+
+      if (count != oldCount)
+        updateObservers(it.key(), count);
+    }
+
+    history.erase(fetched);
+  }
+
+  mSnapshotContactKeys.clear();
+
+  emitRowsChanged(changedRows);
+
+  // Append the sip addresses unknown in the snapshot.
+  if (!history.isEmpty()) {
+    int row = mRefs.count();
+    beginInsertRows(QModelIndex(), row, row + history.count() - 1);
+
+    for (auto it = history.cbegin(); it != history.cend(); ++it, ++row) {
+      auto inserted = mSipAddresses.insert(it.key(), *it);
+      mRefs << &(*inserted);
+      mRows[it.key()] = row;
+      updateSearchIndex(*inserted);
+      updateObservers(it.key(), it->value("unreadMessagesCount", 0).toInt());
+    }
+
+    endInsertRows();
+  }
+
+  // Remove the obsolete sip addresses, from the last row to keep the others valid.
+  sort(removedRows.begin(), removedRows.end());
+  for (int i = removedRows.count() - 1; i >= 0;) {
+    int last = removedRows[i];
+    int first = last;
+    while (--i >= 0 && removedRows[i] == first - 1)
+      first = removedRows[i];
+    removeRows(first, last - first + 1);
+  }
+
+  qInfo() << QStringLiteral("Reconcile timeline snapshot: %1 updated, %2 added, %3 removed.")
+    .arg(changedRows.count()).arg(history.count()).arg(removedRows.count());
+
+  saveSnapshot();
+}
+
+void SipAddressesModel::emitRowsChanged (QVector<int> &rows) {
+  sort(rows.begin(), rows.end());
+  for (int i = 0, n = rows.count(); i < n;) {
+    int first = rows[i];
+    int last = first;
+    while (++i < n && rows[i] <= last + 1)
+      last = rows[i];
+    emit dataChanged(index(first, 0), index(last, 0));
+  }
 }
 
 // -----------------------------------------------------------------------------
 
+void SipAddressesModel::updateSearchIndex (const QVariantMap &map) {
+  const QString sipAddress = map["sipAddress"].toString();
+  const ContactModel *contact = map.value("contact").value<ContactModel *>();
+
+  mSearchIndex.insert(sipAddress, {
+    sipAddress.mid(4),
+    contact ? contact->getUsername() : QString()
+  });
+}
+
 void SipAddressesModel::updateObservers (const QString &sipAddress, ContactModel *contact) {
   for (auto &observer : mObservers.values(sipAddress))
     observer->setContact(contact);
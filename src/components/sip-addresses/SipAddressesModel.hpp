@@ -26,19 +26,22 @@
 #include <QAbstractListModel>
 #include <QUrl>
 
+#include "../search/SearchIndex.hpp"
 #include "SipAddressObserver.hpp"
 
 // =============================================================================
 
 class ChatModel;
 class CoreHandlers;
+class QTimer;
 
 class SipAddressesModel : public QAbstractListModel {
   Q_OBJECT;
 
 public:
-  SipAddressesModel (QObject *parent = Q_NULLPTR);
-  ~SipAddressesModel () = default;
+  // The snapshot is the result of `readSnapshot`. If empty, the history is scanned.
+  SipAddressesModel (QObject *parent = Q_NULLPTR, const QHash<QString, QVariantMap> &snapshot = QHash<QString, QVariantMap>());
+  ~SipAddressesModel ();
 
   int rowCount (const QModelIndex &index = QModelIndex()) const override;
 
@@ -49,6 +52,11 @@ public:
   Q_INVOKABLE ContactModel *mapSipAddressToContact (const QString &sipAddress) const;
   Q_INVOKABLE SipAddressObserver *getSipAddressObserver (const QString &sipAddress);
 
+  // The snapshot contains the sip addresses with history, it's used to fill
+  // the timeline before the chat rooms and call logs are scanned.
+  // Doesn't use the core, so it can be read in a worker thread.
+  static QHash<QString, QVariantMap> readSnapshot ();
+
   // ---------------------------------------------------------------------------
   // Sip addresses helpers.
   // ---------------------------------------------------------------------------
@@ -66,6 +74,18 @@ public:
 
   // ---------------------------------------------------------------------------
 
+  // Sip addresses without `sip:` and contact usernames.
+  const SearchIndex *getSearchIndex () const {
+    return &mSearchIndex;
+  }
+
+  // Number of presence updates replaced by a more recent one before a flush.
+  int getCoalescedPresencesCount () const {
+    return mCoalescedPresencesCount;
+  }
+
+  // ---------------------------------------------------------------------------
+
 private:
   bool removeRow (int row, const QModelIndex &parent = QModelIndex());
   bool removeRows (int row, int count, const QModelIndex &parent = QModelIndex()) override;
@@ -75,7 +95,9 @@ private:
   void handleChatModelCreated (const std::shared_ptr<ChatModel> &chatModel);
 
   void handleContactAdded (ContactModel *contact);
+  void handleContactsAdded (const QList<ContactModel *> &contacts);
   void handleContactRemoved (const ContactModel *contact);
+  void handleContactUpdated (ContactModel *contact);
 
   void handleSipAddressAdded (ContactModel *contact, const QString &sipAddress);
   void handleSipAddressRemoved (ContactModel *contact, const QString &sipAddress);
@@ -83,6 +105,7 @@ private:
   void handleMessageReceived (const std::shared_ptr<linphone::ChatMessage> &message);
   void handleCallStateChanged (const std::shared_ptr<linphone::Call> &call, linphone::CallState state);
   void handlePresenceReceived (const QString &sipAddress, const std::shared_ptr<const linphone::PresenceModel> &presenceModel);
+  void handlePresenceTimeout ();
 
   void handleAllEntriesRemoved (const QString &sipAddress);
   void handleMessageSent (const std::shared_ptr<linphone::ChatMessage> &message);
@@ -105,7 +128,20 @@ private:
 
   void removeContactOfSipAddress (const QString &sipAddress);
 
-  void initSipAddresses ();
+  void initSipAddresses (const QHash<QString, QVariantMap> &snapshot);
+
+  // Fetch the sip addresses of the chat rooms and call logs.
+  QHash<QString, QVariantMap> fetchSipAddresses () const;
+
+  void saveSnapshot () const;
+
+  // Update the rows filled from a snapshot with the fetched history.
+  void reconcileSnapshot ();
+
+  // Emit one `dataChanged` per range of contiguous rows. Duplicates are ignored.
+  void emitRowsChanged (QVector<int> &rows);
+
+  void updateSearchIndex (const QVariantMap &map);
 
   void updateObservers (const QString &sipAddress, ContactModel *contact);
   void updateObservers (const QString &sipAddress, const Presence::PresenceStatus &presenceStatus);
@@ -114,8 +150,24 @@ private:
   QHash<QString, QVariantMap> mSipAddresses;
   QList<const QVariantMap *> mRefs;
 
+  // Sip address => row in `mRefs`.
+  QHash<QString, int> mRows;
+
+  SearchIndex mSearchIndex;
+
   QMultiHash<QString, SipAddressObserver *> mObservers;
 
+  // Presences received since the last event loop iteration. Only the last
+  // status of each sip address is kept and flushed in range `dataChanged`.
+  QHash<QString, Presence::PresenceStatus> mPendingPresences;
+  QTimer *mPresenceTimer = nullptr;
+  int mCoalescedPresencesCount = 0;
+
+  QTimer *mSnapshotTimer = nullptr;
+
+  // Sip address => contact key (username) saved in the snapshot.
+  QHash<QString, QString> mSnapshotContactKeys;
+
   std::shared_ptr<CoreHandlers> mCoreHandlers;
 };
 
@@ -34,18 +34,62 @@ namespace {
   constexpr int cWeightPosOther = 1;
 }
 
-const QRegExp SipAddressesProxyModel::mSearchSeparators("^[^_.-;@ ][_.-;@ ]");
-
 // -----------------------------------------------------------------------------
 
-SipAddressesProxyModel::SipAddressesProxyModel (QObject *parent) : QSortFilterProxyModel(parent) {
-  setSourceModel(CoreManager::getInstance()->getSipAddressesModel());
+SipAddressesProxyModel::SipAddressesProxyModel (QObject *parent) : SipAddressesProxyModel(
+  CoreManager::getInstance()->getSipAddressesModel(),
+  CoreManager::getInstance()->getSipAddressesModel()->getSearchIndex(),
+  parent
+) {}
+
+SipAddressesProxyModel::SipAddressesProxyModel (
+  QAbstractItemModel *sourceModel,
+  const SearchIndex *searchIndex,
+  QObject *parent
+) : QSortFilterProxyModel(parent), mSearchIndex(searchIndex) {
+  // Must be connected before `setSourceModel` to be handled before the proxy updates.
+  QObject::connect(sourceModel, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+    invalidateWeights(topLeft.row(), bottomRight.row());
+  });
+  QObject::connect(sourceModel, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex &, int first, int last) {
+    invalidateWeights(first, last);
+  });
+  QObject::connect(sourceModel, &QAbstractItemModel::modelReset, this, [this] {
+    // Force a complete search.
+    const QString filter = mFilter;
+    mFilter.clear();
+    setFilter(filter);
+  });
+
+  setFilter(QString());
+
+  setSourceModel(sourceModel);
   sort(0);
 }
 
 // -----------------------------------------------------------------------------
 
 void SipAddressesProxyModel::setFilter (const QString &pattern) {
+  // A refined filter can't match a sip address rejected by the previous one.
+  if (!mFilter.isEmpty() && pattern.contains(mFilter, Qt::CaseInsensitive)) {
+    for (auto it = mWeights.begin(); it != mWeights.end(); ) {
+      const SearchIndex::Match match = mSearchIndex->match(it.key(), pattern);
+      if (match.isEmpty())
+        it = mWeights.erase(it);
+      else {
+        *it = computeWeight(match);
+        ++it;
+      }
+    }
+  } else {
+    const QHash<QString, SearchIndex::Match> matches = mSearchIndex->search(pattern);
+
+    mWeights.clear();
+    mWeights.reserve(matches.count());
+    for (auto it = matches.cbegin(); it != matches.cend(); ++it)
+      mWeights.insert(it.key(), computeWeight(*it));
+  }
+
   mFilter = pattern;
   invalidate();
 }
@@ -54,7 +98,7 @@ void SipAddressesProxyModel::setFilter (const QString &pattern) {
 
 bool SipAddressesProxyModel::filterAcceptsRow (int sourceRow, const QModelIndex &sourceParent) const {
   const QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
-  return computeEntryWeight(index.data().toMap()) > 0;
+  return mWeights.contains(index.data().toMap()["sipAddress"].toString());
 }
 
 bool SipAddressesProxyModel::lessThan (const QModelIndex &left, const QModelIndex &right) const {
@@ -64,9 +108,8 @@ bool SipAddressesProxyModel::lessThan (const QModelIndex &left, const QModelInde
   const QString sipAddressA = mapA["sipAddress"].toString();
   const QString sipAddressB = mapB["sipAddress"].toString();
 
-  // TODO: Use a cache, do not compute the same value as `filterAcceptsRow`.
-  int weightA = computeEntryWeight(mapA);
-  int weightB = computeEntryWeight(mapB);
+  int weightA = getEntryWeight(mapA);
+  int weightB = getEntryWeight(mapB);
 
   // 1. Not the same weight.
   if (weightA != weightB)
@@ -96,34 +139,37 @@ bool SipAddressesProxyModel::lessThan (const QModelIndex &left, const QModelInde
   return sipAddressA <= sipAddressB;
 }
 
-int SipAddressesProxyModel::computeEntryWeight (const QVariantMap &entry) const {
-  int weight = computeStringWeight(entry["sipAddress"].toString().mid(4));
-
-  const ContactModel *contact = entry.value("contact").value<ContactModel *>();
-  if (contact)
-    weight += computeStringWeight(contact->getVcardModel()->getUsername());
+void SipAddressesProxyModel::invalidateWeights (int first, int last) {
+  // The contact of a sip address can be changed.
+  QAbstractItemModel *model = sourceModel();
+  for (int row = first; row <= last; ++row)
+    updateWeight(model->index(row, 0).data().toMap()["sipAddress"].toString());
+}
 
-  return weight;
+void SipAddressesProxyModel::updateWeight (const QString &sipAddress) {
+  const SearchIndex::Match match = mSearchIndex->match(sipAddress, mFilter);
+  if (match.isEmpty())
+    mWeights.remove(sipAddress);
+  else
+    mWeights[sipAddress] = computeWeight(match);
 }
 
-int SipAddressesProxyModel::computeStringWeight (const QString &string) const {
-  int index = -1;
-  int offset = -1;
+int SipAddressesProxyModel::getEntryWeight (const QVariantMap &entry) const {
+  return mWeights.value(entry["sipAddress"].toString(), 0);
+}
 
-  while ((index = string.indexOf(mFilter, index + 1, Qt::CaseInsensitive)) != -1) {
-    int tmpOffset = index - string.lastIndexOf(mSearchSeparators, index) - 1;
-    if ((tmpOffset != -1 && tmpOffset < offset) || offset == -1)
-      if ((offset = tmpOffset) == 0) break;
-  }
+int SipAddressesProxyModel::computeWeight (const SearchIndex::Match &match) {
+  int weight = 0;
 
-  switch (offset) {
-    case -1: return 0;
-    case 0: return cWeightPos0;
-    case 1: return cWeightPos1;
-    case 2: return cWeightPos2;
-    case 3: return cWeightPos3;
-    default: break;
-  }
+  for (int offset : match)
+    switch (offset) {
+      case -1: break;
+      case 0: weight += cWeightPos0; break;
+      case 1: weight += cWeightPos1; break;
+      case 2: weight += cWeightPos2; break;
+      case 3: weight += cWeightPos3; break;
+      default: weight += cWeightPosOther; break;
+    }
 
-  return cWeightPosOther;
+  return weight;
 }
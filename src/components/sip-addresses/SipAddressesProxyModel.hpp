@@ -25,6 +25,8 @@
 
 #include <QSortFilterProxyModel>
 
+#include "../search/SearchIndex.hpp"
+
 // =============================================================================
 
 class SipAddressesProxyModel : public QSortFilterProxyModel {
@@ -32,6 +34,7 @@ class SipAddressesProxyModel : public QSortFilterProxyModel {
 
 public:
   SipAddressesProxyModel (QObject *parent = Q_NULLPTR);
+  SipAddressesProxyModel (QAbstractItemModel *sourceModel, const SearchIndex *searchIndex, QObject *parent = Q_NULLPTR);
   ~SipAddressesProxyModel () = default;
 
   Q_INVOKABLE void setFilter (const QString &pattern);
@@ -41,12 +44,20 @@ protected:
   bool lessThan (const QModelIndex &left, const QModelIndex &right) const override;
 
 private:
-  int computeEntryWeight (const QVariantMap &entry) const;
-  int computeStringWeight (const QString &string) const;
+  void invalidateWeights (int first, int last);
+  void updateWeight (const QString &sipAddress);
+
+  int getEntryWeight (const QVariantMap &entry) const;
+
+  static int computeWeight (const SearchIndex::Match &match);
 
   QString mFilter;
 
-  static const QRegExp mSearchSeparators;
+  // Sip address => weight for the current filter. Only the matching sip addresses
+  // are stored. If the filter is refined, only these ones are checked again.
+  QHash<QString, int> mWeights;
+
+  const SearchIndex *mSearchIndex = nullptr;
 };
 
 #endif // SIP_ADDRESSES_PROXY_MODEL_H_
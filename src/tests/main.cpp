@@ -28,6 +28,7 @@
 
 #include "assistant-view/AssistantViewTest.hpp"
 #include "main-view/MainViewTest.hpp"
+#include "models-benchmark/ModelsBenchmarkTest.hpp"
 #include "self-test/SelfTest.hpp"
 
 // =============================================================================
@@ -36,6 +37,7 @@ static QHash<QString, QObject *> initializeTests () {
   QHash<QString, QObject *> hash;
   hash["assistant-view"] = new AssistantViewTest();
   hash["main-view"] = new MainViewTest();
+  hash["models-benchmark"] = new ModelsBenchmarkTest();
   return hash;
 }
 
@@ -0,0 +1,332 @@
+/*
+ * ModelsBenchmarkTest.cpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#include <algorithm>
+
+#include <QDateTime>
+#include <QStandardItemModel>
+#include <QTest>
+
+#include "../../components/chat/ChatModel.hpp"
+#include "../../components/sip-addresses/SipAddressesProxyModel.hpp"
+
+#include "ModelsBenchmarkTest.hpp"
+
+// =============================================================================
+
+using namespace std;
+
+namespace {
+  constexpr int cChatEntriesCount = 10000;
+  constexpr int cSipAddressesCount = 50000;
+  constexpr int cSearchIndexCount = 100000;
+
+  // Entry layout used before the typed `ChatModel::ChatEntryData`.
+  typedef QPair<QVariantMap, shared_ptr<void> > LegacyChatEntryData;
+}
+
+static qint64 getTimestamp (int i) {
+  // Pseudo-random but reproducible timestamps.
+  return qint64(1500000000) * 1000 + qint64((i * 7919) % cChatEntriesCount) * 1000;
+}
+
+static LegacyChatEntryData createLegacyEntry (int i) {
+  QVariantMap map;
+  map["type"] = ChatModel::MessageEntry;
+  map["timestamp"] = QDateTime::fromMSecsSinceEpoch(getTimestamp(i));
+  map["content"] = QStringLiteral("Message %1").arg(i);
+  map["isOutgoing"] = bool(i % 2);
+  map["status"] = int(ChatModel::MessageStatusDelivered);
+  return qMakePair(map, shared_ptr<void>());
+}
+
+static ChatModel::ChatEntryData createEntry (int i) {
+  ChatModel::ChatEntryData entry;
+  entry.type = ChatModel::MessageEntry;
+  entry.timestamp = getTimestamp(i);
+  entry.content = QStringLiteral("Message %1").arg(i);
+  entry.isOutgoing = bool(i % 2);
+  entry.status = ChatModel::MessageStatusDelivered;
+  return entry;
+}
+
+// Rough heap estimation: QMapData node + key + variant per field.
+static size_t estimateLegacyEntrySize (const LegacyChatEntryData &entry) {
+  const QVariantMap &map = entry.first;
+  size_t size = sizeof(LegacyChatEntryData);
+  for (auto it = map.cbegin(); it != map.cend(); ++it) {
+    size += sizeof(void *) * 3 + sizeof(QString) + sizeof(QVariant);
+    size += size_t(it.key().capacity()) * sizeof(QChar);
+    if (it.value().type() == QVariant::String)
+      size += size_t(it.value().toString().capacity()) * sizeof(QChar);
+    else if (it.value().type() == QVariant::DateTime)
+      size += sizeof(void *) * 4;
+  }
+  return size;
+}
+
+static size_t estimateEntrySize (const ChatModel::ChatEntryData &entry) {
+  return sizeof(ChatModel::ChatEntryData) + size_t(entry.content.capacity()) * sizeof(QChar);
+}
+
+// -----------------------------------------------------------------------------
+
+void ModelsBenchmarkTest::chatEntriesMemory () {
+  const LegacyChatEntryData legacyEntry = ::createLegacyEntry(0);
+  const ChatModel::ChatEntryData entry = ::createEntry(0);
+
+  const size_t legacySize = ::estimateLegacyEntrySize(legacyEntry);
+  const size_t size = ::estimateEntrySize(entry);
+
+  qInfo() << QStringLiteral("Estimated memory per chat entry: %1 bytes (legacy: %2 bytes).")
+    .arg(size).arg(legacySize);
+
+  QVERIFY(size < legacySize);
+}
+
+// -----------------------------------------------------------------------------
+
+void ModelsBenchmarkTest::chatEntriesSort_data () {
+  QTest::addColumn<bool>("legacy");
+
+  QTest::newRow("legacy") << true;
+  QTest::newRow("typed") << false;
+}
+
+void ModelsBenchmarkTest::chatEntriesSort () {
+  QFETCH(bool, legacy);
+
+  if (legacy) {
+    QList<LegacyChatEntryData> entries;
+    for (int i = 0; i < cChatEntriesCount; ++i)
+      entries << ::createLegacyEntry(i);
+
+    QBENCHMARK {
+      QList<LegacyChatEntryData> copy = entries;
+      stable_sort(copy.begin(), copy.end(), [](const LegacyChatEntryData &a, const LegacyChatEntryData &b) {
+        return a.first["timestamp"].toDateTime() < b.first["timestamp"].toDateTime();
+      });
+    }
+    return;
+  }
+
+  QVector<ChatModel::ChatEntryData> entries;
+  entries.reserve(cChatEntriesCount);
+  for (int i = 0; i < cChatEntriesCount; ++i)
+    entries << ::createEntry(i);
+
+  QBENCHMARK {
+    QVector<ChatModel::ChatEntryData> copy = entries;
+    stable_sort(copy.begin(), copy.end(), [](const ChatModel::ChatEntryData &a, const ChatModel::ChatEntryData &b) {
+      return a.timestamp < b.timestamp;
+    });
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void ModelsBenchmarkTest::chatEntriesInsert_data () {
+  chatEntriesSort_data();
+}
+
+void ModelsBenchmarkTest::chatEntriesInsert () {
+  QFETCH(bool, legacy);
+
+  if (legacy) {
+    QBENCHMARK {
+      QList<LegacyChatEntryData> entries;
+      for (int i = 0; i < cChatEntriesCount; ++i) {
+        const LegacyChatEntryData entry = ::createLegacyEntry(i);
+        auto it = lower_bound(entries.begin(), entries.end(), entry, [](const LegacyChatEntryData &a, const LegacyChatEntryData &b) {
+          return a.first["timestamp"] < b.first["timestamp"];
+        });
+        entries.insert(it, entry);
+      }
+    }
+    return;
+  }
+
+  QBENCHMARK {
+    QVector<ChatModel::ChatEntryData> entries;
+    for (int i = 0; i < cChatEntriesCount; ++i) {
+      const ChatModel::ChatEntryData entry = ::createEntry(i);
+      auto it = lower_bound(entries.begin(), entries.end(), entry, [](const ChatModel::ChatEntryData &a, const ChatModel::ChatEntryData &b) {
+        return a.timestamp < b.timestamp;
+      });
+      entries.insert(it, entry);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+void ModelsBenchmarkTest::sipAddressesRowLookup_data () {
+  QTest::addColumn<bool>("legacy");
+
+  QTest::newRow("legacy") << true;
+  QTest::newRow("indexed") << false;
+}
+
+void ModelsBenchmarkTest::sipAddressesRowLookup () {
+  QFETCH(bool, legacy);
+
+  // Same layout as `SipAddressesModel`.
+  QHash<QString, QVariantMap> sipAddresses;
+  QList<const QVariantMap *> refs;
+  QHash<QString, int> rows;
+
+  for (int i = 0; i < cSipAddressesCount; ++i) {
+    const QString sipAddress = QStringLiteral("sip:user-%1@sip.example.org").arg(i);
+
+    QVariantMap map;
+    map["sipAddress"] = sipAddress;
+    sipAddresses[sipAddress] = map;
+  }
+  for (auto it = sipAddresses.cbegin(); it != sipAddresses.cend(); ++it) {
+    rows[it.key()] = refs.count();
+    refs << &(*it);
+  }
+
+  // Lookup of 1000 sip addresses. (Presence notifications for example.)
+  QStringList lookups;
+  for (int i = 0; i < 1000; ++i)
+    lookups << QStringLiteral("sip:user-%1@sip.example.org").arg((i * 7919) % cSipAddressesCount);
+
+  int found = 0;
+  if (legacy)
+    QBENCHMARK {
+      for (const QString &sipAddress : lookups)
+        found += refs.indexOf(&(*sipAddresses.constFind(sipAddress))) != -1;
+    }
+  else
+    QBENCHMARK {
+      for (const QString &sipAddress : lookups)
+        found += rows.value(sipAddress, -1) != -1;
+    }
+
+  QVERIFY(found > 0);
+}
+
+// -----------------------------------------------------------------------------
+
+void ModelsBenchmarkTest::sipAddressesFilter_data () {
+  QTest::addColumn<bool>("typed");
+
+  QTest::newRow("pasted") << false;
+  QTest::newRow("typed") << true;
+}
+
+void ModelsBenchmarkTest::sipAddressesFilter () {
+  QFETCH(bool, typed);
+
+  QStandardItemModel model;
+  SearchIndex searchIndex;
+  for (int i = 0; i < cSipAddressesCount; ++i) {
+    const QString sipAddress = QStringLiteral("sip:user-%1@sip.example.org").arg(i);
+
+    QVariantMap map;
+    map["sipAddress"] = sipAddress;
+
+    QStandardItem *item = new QStandardItem();
+    item->setData(map, Qt::DisplayRole);
+    model.appendRow(item);
+
+    searchIndex.insert(sipAddress, { sipAddress.mid(4), QString() });
+  }
+
+  SipAddressesProxyModel proxyModel(&model, &searchIndex);
+
+  const QString filter = QStringLiteral("user-4242");
+  QBENCHMARK {
+    proxyModel.setFilter(QString());
+    if (typed)
+      for (int i = 1; i < filter.length(); ++i)
+        proxyModel.setFilter(filter.left(i));
+    proxyModel.setFilter(filter);
+  }
+
+  // `user-4242` and `user-42420` to `user-42429`.
+  QCOMPARE(proxyModel.rowCount(), 11);
+}
+
+// -----------------------------------------------------------------------------
+
+void ModelsBenchmarkTest::searchIndexQuery_data () {
+  QTest::addColumn<QString>("pattern");
+  QTest::addColumn<int>("count");
+
+  QTest::newRow("no match") << QStringLiteral("unknown") << 0;
+  QTest::newRow("short pattern") << QStringLiteral("99") << 3691;
+  QTest::newRow("username") << QStringLiteral("Doe 4242") << 11;
+  QTest::newRow("sip address") << QStringLiteral("user-4242@") << 1;
+}
+
+void ModelsBenchmarkTest::searchIndexQuery () {
+  QFETCH(QString, pattern);
+  QFETCH(int, count);
+
+  SearchIndex searchIndex;
+  for (int i = 0; i < cSearchIndexCount; ++i)
+    searchIndex.insert(QString::number(i), {
+      QStringLiteral("John Doe %1").arg(i),
+      QStringLiteral("user-%1@sip.example.org").arg(i)
+    });
+
+  QHash<QString, SearchIndex::Match> matches;
+  QBENCHMARK {
+    matches = searchIndex.search(pattern);
+  }
+
+  QCOMPARE(matches.count(), count);
+}
+
+void ModelsBenchmarkTest::searchIndexRanking_data () {
+  QTest::addColumn<QString>("sipAddress");
+  QTest::addColumn<QString>("pattern");
+  QTest::addColumn<int>("offset");
+
+  QTest::newRow("user") << QStringLiteral("sip:alice@sip.example.org") << QStringLiteral("alice") << 0;
+  QTest::newRow("domain") << QStringLiteral("sip:alice@sip.example.org") << QStringLiteral("example") << 0;
+  QTest::newRow("after digit") << QStringLiteral("sip:user42alice@sip.example.org") << QStringLiteral("alice") << 0;
+  QTest::newRow("in word") << QStringLiteral("sip:malice@sip.example.org") << QStringLiteral("alice") << 1;
+}
+
+void ModelsBenchmarkTest::searchIndexRanking () {
+  QFETCH(QString, sipAddress);
+  QFETCH(QString, pattern);
+  QFETCH(int, offset);
+
+  // Same fields as `ContactsListModel`: the username, then the sip addresses without scheme.
+  SearchIndex searchIndex;
+  searchIndex.insert(sipAddress, { QStringLiteral("Bob"), sipAddress.mid(4) });
+
+  // The offset from the start of the word gives the ranking tier of the field.
+  const SearchIndex::Match match = searchIndex.match(sipAddress, pattern);
+  QCOMPARE(match.count(), 2);
+  QCOMPARE(match[0], -1);
+  QCOMPARE(match[1], offset);
+
+  // Matched at the start of a word in the full sip address too.
+  if (offset == 0) {
+    searchIndex.insert(sipAddress, { QStringLiteral("Bob"), sipAddress });
+    QCOMPARE(searchIndex.match(sipAddress, pattern).value(1), 0);
+  }
+}
@@ -0,0 +1,58 @@
+/*
+ * ModelsBenchmarkTest.hpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef MODELS_BENCHMARK_TEST_H_
+#define MODELS_BENCHMARK_TEST_H_
+
+#include <QObject>
+
+// =============================================================================
+
+class ModelsBenchmarkTest : public QObject {
+  Q_OBJECT;
+
+public:
+  ModelsBenchmarkTest () = default;
+  ~ModelsBenchmarkTest () = default;
+
+private slots:
+  void chatEntriesMemory ();
+
+  void chatEntriesSort_data ();
+  void chatEntriesSort ();
+
+  void chatEntriesInsert_data ();
+  void chatEntriesInsert ();
+
+  void sipAddressesRowLookup_data ();
+  void sipAddressesRowLookup ();
+
+  void sipAddressesFilter_data ();
+  void sipAddressesFilter ();
+
+  void searchIndexQuery_data ();
+  void searchIndexQuery ();
+
+  void searchIndexRanking_data ();
+  void searchIndexRanking ();
+};
+
+#endif // ifndef MODELS_BENCHMARK_TEST_H_
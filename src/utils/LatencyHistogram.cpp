@@ -0,0 +1,89 @@
+/*
+ * LatencyHistogram.cpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#include "LatencyHistogram.hpp"
+
+// =============================================================================
+
+namespace {
+  // Upper bound of the first bucket, in microseconds. The last bucket is unbounded.
+  constexpr qint64 cFirstBucketBound = 128;
+}
+
+static inline qint64 getBucketBound (int bucket) {
+  return cFirstBucketBound << bucket;
+}
+
+static inline QString formatDuration (qint64 value) {
+  return QStringLiteral("%1ms").arg(double(value) / 1000.0, 0, 'f', 2);
+}
+
+// -----------------------------------------------------------------------------
+
+LatencyHistogram::LatencyHistogram (const QString &name) : mName(name) {
+  reset();
+}
+
+void LatencyHistogram::add (qint64 value) {
+  int bucket = 0;
+  while (bucket < BucketsCount - 1 && value >= getBucketBound(bucket))
+    ++bucket;
+
+  ++mBuckets[bucket];
+  ++mCount;
+  mSum += value;
+  if (value > mMax)
+    mMax = value;
+}
+
+void LatencyHistogram::reset () {
+  for (int &bucket : mBuckets)
+    bucket = 0;
+
+  mCount = 0;
+  mMax = 0;
+  mSum = 0;
+}
+
+qint64 LatencyHistogram::getPercentile (int percentile) const {
+  const qint64 limit = (qint64(mCount) * percentile + 99) / 100;
+
+  qint64 count = 0;
+  for (int bucket = 0; bucket < BucketsCount - 1; ++bucket)
+    if ((count += mBuckets[bucket]) >= limit)
+      return getBucketBound(bucket);
+
+  return mMax;
+}
+
+QString LatencyHistogram::toString () const {
+  if (!mCount)
+    return QStringLiteral("%1: no samples.").arg(mName);
+
+  return QStringLiteral("%1: %2 samples, average %3, p50 < %4, p90 < %5, p99 < %6, max %7.")
+    .arg(mName)
+    .arg(mCount)
+    .arg(formatDuration(mSum / mCount))
+    .arg(formatDuration(getPercentile(50)))
+    .arg(formatDuration(getPercentile(90)))
+    .arg(formatDuration(getPercentile(99)))
+    .arg(formatDuration(mMax));
+}
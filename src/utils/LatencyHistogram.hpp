@@ -0,0 +1,63 @@
+/*
+ * LatencyHistogram.hpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef LATENCY_HISTOGRAM_H_
+#define LATENCY_HISTOGRAM_H_
+
+#include <QString>
+
+// =============================================================================
+// Durations in microseconds, counted in power of two buckets.
+// =============================================================================
+
+class LatencyHistogram {
+public:
+  LatencyHistogram (const QString &name);
+  ~LatencyHistogram () = default;
+
+  void add (qint64 value);
+  void reset ();
+
+  int getCount () const {
+    return mCount;
+  }
+
+  qint64 getMax () const {
+    return mMax;
+  }
+
+  // Upper bound of the bucket which contains the percentile.
+  qint64 getPercentile (int percentile) const;
+
+  QString toString () const;
+
+private:
+  static constexpr int BucketsCount = 16;
+
+  QString mName;
+
+  int mBuckets[BucketsCount];
+  int mCount = 0;
+  qint64 mMax = 0;
+  qint64 mSum = 0;
+};
+
+#endif // LATENCY_HISTOGRAM_H_
@@ -0,0 +1,156 @@
+/*
+ * StartupProfiler.cpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#include <atomic>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <QVector>
+
+#include "StartupProfiler.hpp"
+
+// =============================================================================
+
+namespace {
+  struct Event {
+    const char *name;
+    qint64 start; // In microseconds since the first span.
+    qint64 duration;
+    int threadId;
+  };
+
+  struct Profile {
+    Profile () {
+      clock.start();
+    }
+
+    QMutex mutex;
+    QElapsedTimer clock;
+    QString outputPath;
+
+    QVector<Event> events;
+    QHash<QThread *, int> threadIds;
+  };
+
+  std::atomic<bool> gFinished(false);
+
+  Profile &getProfile () {
+    static Profile profile;
+    return profile;
+  }
+
+  inline qint64 now () {
+    return getProfile().clock.nsecsElapsed() / 1000;
+  }
+}
+
+// -----------------------------------------------------------------------------
+
+StartupProfiler::Span::Span (const char *name) : mName(name), mStart(gFinished ? -1 : now()) {}
+
+StartupProfiler::Span::~Span () {
+  if (mStart >= 0)
+    addEvent(mName, mStart, now());
+}
+
+// -----------------------------------------------------------------------------
+
+void StartupProfiler::setOutputPath (const QString &path) {
+  Profile &profile = getProfile();
+  QMutexLocker locker(&profile.mutex);
+  profile.outputPath = path;
+}
+
+void StartupProfiler::finish () {
+  if (gFinished.exchange(true))
+    return;
+
+  Profile &profile = getProfile();
+  QMutexLocker locker(&profile.mutex);
+
+  if (profile.outputPath.isEmpty()) {
+    profile.events.clear();
+    return;
+  }
+
+  const qint64 pid = QCoreApplication::applicationPid();
+  QJsonArray traceEvents;
+
+  for (auto it = profile.threadIds.cbegin(); it != profile.threadIds.cend(); ++it)
+    traceEvents.append(QJsonObject{
+      { "name", "thread_name" },
+      { "ph", "M" },
+      { "pid", pid },
+      { "tid", it.value() },
+      { "args", QJsonObject{ { "name", it.value() ? QStringLiteral("Worker %1").arg(it.value()) : QStringLiteral("Main") } } }
+    });
+
+  for (const auto &event : profile.events)
+    traceEvents.append(QJsonObject{
+      { "name", event.name },
+      { "cat", "startup" },
+      { "ph", "X" },
+      { "ts", event.start },
+      { "dur", event.duration },
+      { "pid", pid },
+      { "tid", event.threadId }
+    });
+
+  QSaveFile file(profile.outputPath);
+  if (
+    !file.open(QIODevice::WriteOnly) ||
+    file.write(QJsonDocument(QJsonObject{
+      { "traceEvents", traceEvents },
+      { "displayTimeUnit", "ms" }
+    }).toJson(QJsonDocument::Compact)) < 0 ||
+    !file.commit()
+  )
+    qWarning() << QStringLiteral("Unable to write startup trace: `%1`.").arg(profile.outputPath);
+  else
+    qInfo() << QStringLiteral("Startup trace (%1 spans) written to: `%2`.")
+      .arg(profile.events.count()).arg(profile.outputPath);
+
+  profile.events.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+void StartupProfiler::addEvent (const char *name, qint64 start, qint64 end) {
+  Profile &profile = getProfile();
+  QMutexLocker locker(&profile.mutex);
+  if (gFinished)
+    return;
+
+  // The main thread is always the first one to record a span.
+  QThread *thread = QThread::currentThread();
+  auto it = profile.threadIds.find(thread);
+  if (it == profile.threadIds.end())
+    it = profile.threadIds.insert(thread, profile.threadIds.count());
+
+  profile.events.append({ name, start, end - start, it.value() });
+}
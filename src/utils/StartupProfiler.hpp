@@ -0,0 +1,54 @@
+/*
+ * StartupProfiler.hpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#ifndef STARTUP_PROFILER_H_
+#define STARTUP_PROFILER_H_
+
+#include <QString>
+
+// =============================================================================
+// Scoped spans of the startup phases, written in the Chrome trace event format.
+// Can be opened with `chrome://tracing` or Perfetto.
+// =============================================================================
+
+class StartupProfiler {
+public:
+  class Span {
+  public:
+    Span (const char *name);
+    ~Span ();
+
+  private:
+    const char *mName;
+    qint64 mStart;
+  };
+
+  // The spans are recorded until `finish`. They are written only if a path is set.
+  static void setOutputPath (const QString &path);
+  static void finish ();
+
+private:
+  StartupProfiler () = delete;
+
+  static void addEvent (const char *name, qint64 start, qint64 end);
+};
+
+#endif // STARTUP_PROFILER_H_
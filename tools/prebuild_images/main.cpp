@@ -0,0 +1,136 @@
+/*
+ * main.cpp
+ * Copyright (C) 2017-2018  Belledonne Communications, Grenoble, France
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *  Created on: October 18, 2026
+ */
+
+#include <QDir>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QSvgRenderer>
+
+#include "../../src/app/providers/SvgColorizer.hpp"
+#include "../../src/components/other/colors/Colors.hpp"
+
+// =============================================================================
+// Build tool: recolor the svg images with the default palette and rasterize
+// them at their natural size and at the given sizes. Produces a qrc file used
+// by `ImageProvider`.
+//
+// Usage: prebuild_images <images dir> <output dir> [size...]
+// =============================================================================
+
+namespace {
+  constexpr char cQrcFileName[] = "prebuilt_images.qrc";
+}
+
+static bool writeFile (const QString &path, const QByteArray &content) {
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size()) {
+    qWarning() << QStringLiteral("Unable to write: `%1`.").arg(path);
+    return false;
+  }
+  return true;
+}
+
+// A null size is the natural size of the svg, i.e. the size of an `Image`
+// without `sourceSize`.
+static bool rasterize (const QByteArray &content, int size, const QString &path) {
+  QSvgRenderer renderer(content);
+  if (!renderer.isValid())
+    return false;
+
+  const QRectF viewBox = renderer.viewBoxF();
+  QImage image(
+    size > 0 ? size : int(viewBox.width()),
+    size > 0 ? size : int(viewBox.height()),
+    QImage::Format_ARGB32
+  );
+  if (image.isNull())
+    return false;
+  image.fill(0x00000000);
+
+  {
+    QPainter painter(&image);
+    renderer.render(&painter);
+  }
+
+  return image.save(path, "png");
+}
+
+// -----------------------------------------------------------------------------
+
+int main (int argc, char *argv[]) {
+  if (argc < 3) {
+    qWarning() << QStringLiteral("Usage: %1 <images dir> <output dir> [size...]").arg(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  // No display is required.
+  qputenv("QT_QPA_PLATFORM", "offscreen");
+  QGuiApplication app(argc, argv);
+
+  const QDir imagesDir(QString::fromLocal8Bit(argv[1]));
+  const QDir outputDir(QString::fromLocal8Bit(argv[2]));
+
+  QList<int> sizes;
+  for (int i = 3; i < argc; ++i)
+    sizes << QString::fromLocal8Bit(argv[i]).toInt();
+
+  outputDir.mkpath(QStringLiteral("natural"));
+  for (int size : sizes)
+    outputDir.mkpath(QStringLiteral("%1x%1").arg(size));
+
+  // Default palette.
+  const Colors colors;
+
+  QByteArray qrc = "<!DOCTYPE RCC><RCC version=\"1.0\">\n  <qresource prefix=\"/prebuilt-images\">\n";
+
+  for (const QFileInfo &info : imagesDir.entryInfoList({ "*.svg" }, QDir::Files, QDir::Name)) {
+    QFile file(info.absoluteFilePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+      qWarning() << QStringLiteral("Unable to open: `%1`.").arg(file.fileName());
+      return EXIT_FAILURE;
+    }
+
+    const QByteArray content = SvgColorizer::colorize(file, colors);
+    if (content.isEmpty()) {
+      qWarning() << QStringLiteral("Unable to parse: `%1`.").arg(file.fileName());
+      return EXIT_FAILURE;
+    }
+
+    if (!::writeFile(outputDir.filePath(info.fileName()), content))
+      return EXIT_FAILURE;
+    qrc.append(QStringLiteral("    <file>%1</file>\n").arg(info.fileName()).toUtf8());
+
+    for (int size : QList<int>(sizes) << 0) {
+      const QString name = size > 0
+        ? QStringLiteral("%1x%1/%2.png").arg(size).arg(info.completeBaseName())
+        : QStringLiteral("natural/%1.png").arg(info.completeBaseName());
+      if (!::rasterize(content, size, outputDir.filePath(name))) {
+        qWarning() << QStringLiteral("Unable to rasterize: `%1`.").arg(name);
+        return EXIT_FAILURE;
+      }
+      qrc.append(QStringLiteral("    <file>%1</file>\n").arg(name).toUtf8());
+    }
+  }
+
+  qrc.append("  </qresource>\n</RCC>\n");
+
+  return ::writeFile(outputDir.filePath(cQrcFileName), qrc) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
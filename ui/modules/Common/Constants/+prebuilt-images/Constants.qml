@@ -0,0 +1,15 @@
+pragma Singleton
+import QtQuick 2.7
+
+// =============================================================================
+// Used with `ENABLE_PREBUILT_IMAGES`: the icons are loaded by `ImageProvider`.
+// =============================================================================
+
+QtObject {
+  property int zPopup: 999
+  property int zMax: 999999
+  property int sizeMax: 999999
+
+  property string imagesFormat: '.svg'
+  property string imagesPath: 'image://internal/'
+}
@@ -20,19 +20,22 @@ function loadMoreEntries () {
     chat.tryToLoadMoreEntries = true
     chat.positionViewAtBeginning()
     container.proxyModel.loadMoreEntries()
+  } else if (chat.atYEnd && !chat.bindToEnd) {
+    // The newest entries can be evicted after a long scroll in the history.
+    container.proxyModel.loadNewerEntries()
   }
 }
 
-function getComponentFromEntry (chatEntry) {
-  if (chatEntry.fileName) {
+function getComponentFromEntry (type, fileName, isOutgoing) {
+  if (fileName) {
     return 'FileMessage.qml'
   }
 
-  if (chatEntry.type === Linphone.ChatModel.CallEntry) {
+  if (type === Linphone.ChatModel.CallEntry) {
     return 'Event.qml'
   }
 
-  return chatEntry.isOutgoing ? 'OutgoingMessage.qml' : 'IncomingMessage.qml'
+  return isOutgoing ? 'OutgoingMessage.qml' : 'IncomingMessage.qml'
 }
 
 function getIsComposingMessage () {
@@ -53,7 +56,9 @@ function handleFilesDropped (files) {
 }
 
 function handleMoreEntriesLoaded (n) {
-  chat.positionViewAtIndex(n - 1, QtQuick.ListView.Beginning)
+  if (n > 0) {
+    chat.positionViewAtIndex(n - 1, QtQuick.ListView.Beginning)
+  }
   chat.tryToLoadMoreEntries = false
 }
 
@@ -167,7 +167,7 @@ Rectangle {
               color: ChatStyle.entry.time.color
               font.pointSize: ChatStyle.entry.time.pointSize
 
-              text: $chatEntry.timestamp.toLocaleString(
+              text: $timestamp.toLocaleString(
                 Qt.locale(App.locale),
                 'hh:mm'
               )
@@ -175,14 +175,14 @@ Rectangle {
               verticalAlignment: Text.AlignVCenter
 
               TooltipArea {
-                text: $chatEntry.timestamp.toLocaleString(Qt.locale(App.locale))
+                text: $timestamp.toLocaleString(Qt.locale(App.locale))
               }
             }
 
             // Display content.
             Loader {
               Layout.fillWidth: true
-              source: Logic.getComponentFromEntry($chatEntry)
+              source: Logic.getComponentFromEntry($type, $fileName, $isOutgoing)
             }
           }
         }
@@ -38,10 +38,10 @@ Item {
             ChatModel.MessageStatusIdle,
             ChatModel.MessageStatusInProgress,
             ChatModel.MessageStatusNotDelivered
-          ], $chatEntry.status)
+          ], $status)
 
-          readonly property bool isRead: $chatEntry.status === ChatModel.MessageStatusDisplayed
-          readonly property bool isDeliveredToUser: $chatEntry.status === ChatModel.MessageStatusDeliveredToUser
+          readonly property bool isRead: $status === ChatModel.MessageStatusDisplayed
+          readonly property bool isDeliveredToUser: $status === ChatModel.MessageStatusDeliveredToUser
 
           icon: isNotDelivered
             ? 'chat_error'
@@ -80,7 +80,7 @@ Item {
         height: ChatStyle.entry.lineHeight
         width: ChatStyle.entry.message.outgoing.areaSize
 
-        sourceComponent: $chatEntry.status === ChatModel.MessageStatusInProgress
+        sourceComponent: $status === ChatModel.MessageStatusInProgress
           ? indicator
           : icon
       }